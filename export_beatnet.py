@@ -1,4 +1,5 @@
 import os
+import argparse
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
@@ -52,7 +53,42 @@ class BDA_ONNX(nn.Module):
         
         return out, new_hidden, new_cell
 
+def export_reference_features(audio_path, out_prefix):
+    """Writes BeatNet's own input features for an audio file so the C++
+    front-end can be checked against them (see test_feature_reference in
+    tests/unit_tests.cpp).
+
+    <out_prefix>.audio.f32     mono float32 samples at 22050 Hz
+    <out_prefix>.features.f32  float32 [frames][272], frame k centred on sample k * 441
+    """
+    import numpy as np
+    import librosa
+    from BeatNet.log_spect import LOG_SPECT
+
+    sample_rate = 22050
+    win_length = int(0.064 * sample_rate)  # 1411
+    hop_length = int(0.020 * sample_rate)  # 441
+
+    audio, _ = librosa.load(audio_path, sr=sample_rate, mono=True)
+    proc = LOG_SPECT(num_channels=1, sample_rate=sample_rate, win_length=win_length,
+                     hop_size=hop_length, n_bands=[24], mode='offline')
+    feats = proc.process_audio(audio).T  # (frames, 272)
+
+    audio.astype(np.float32).tofile(out_prefix + ".audio.f32")
+    np.ascontiguousarray(feats, dtype=np.float32).tofile(out_prefix + ".features.f32")
+    print(f"Wrote {feats.shape[0]} frames x {feats.shape[1]} features to {out_prefix}.features.f32")
+
 def main():
+    parser = argparse.ArgumentParser(description="Export BeatNet to ONNX")
+    parser.add_argument("--reference-features", metavar="AUDIO",
+                        help="instead of exporting, dump BeatNet's input features for AUDIO")
+    parser.add_argument("--out", default="beatnet_reference",
+                        help="output prefix for --reference-features")
+    args = parser.parse_args()
+    if args.reference_features:
+        export_reference_features(args.reference_features, args.out)
+        return
+
     print("Loading original BeatNet weights...")
     device = 'cpu'
     original_model = BDA(272, 150, 2, device)
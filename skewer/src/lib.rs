@@ -152,6 +152,13 @@ impl BeatMapper {
         )
     }
 
+    /// Sidecar read by invasiv's video sync (`<clip>.beats.json`): how many
+    /// 0.5s beats one loop of the exported clip spans, and where beat 0 sits.
+    pub fn beat_sidecar_json(&self) -> String {
+        let beats = (self.total_warped_duration() / 0.5).round().max(1.0);
+        serde_json::json!({ "beats": beats, "anchor": 0.0 }).to_string()
+    }
+
     pub fn calculate_warped_time(&self, musical_time: f64) -> f64 {
         let mut active_beats = self.beats.clone();
         active_beats.retain(|b| b.time >= self.trim_start && b.time <= self.trim_end);
@@ -475,7 +482,12 @@ impl eframe::App for BeatMapper {
                         if !parts.is_empty() {
                             let mut cmd = Command::new(parts[0]);
                             for arg in &parts[1..] { cmd.arg(arg.replace("\"", "")); }
-                            let _ = cmd.status();
+                            if cmd.status().map(|s| s.success()).unwrap_or(false) {
+                                let sidecar = format!("{}.beats.json", output.to_string_lossy());
+                                if let Err(e) = std::fs::write(&sidecar, self.beat_sidecar_json()) {
+                                    log::error!("Failed to write {}: {}", sidecar, e);
+                                }
+                            }
                         }
                     }
                 }
@@ -669,6 +681,21 @@ mod tests {
         assert!((t - 1.5).abs() < 0.001);
     }
 
+    #[test]
+    fn test_beat_sidecar() {
+        let mut app = BeatMapper::default();
+        app.trim_start = 0.0;
+        app.trim_end = 10.0;
+        app.beats = vec![
+            Beat { time: 0.0, weight: 4 },
+            Beat { time: 1.0, weight: 2 },
+            Beat { time: 2.0, weight: 1 }
+        ];
+        let v: serde_json::Value = serde_json::from_str(&app.beat_sidecar_json()).unwrap();
+        assert_eq!(v["beats"].as_f64(), Some(6.0));
+        assert_eq!(v["anchor"].as_f64(), Some(0.0));
+    }
+
     #[test]
     fn test_beat_serialization() {
         let beats = vec![Beat { time: 1.23, weight: 4 }];
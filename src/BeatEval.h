@@ -0,0 +1,156 @@
+#pragma once
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Beat tracking scores following mir_eval.beat: F-measure with a +-70ms
+// window and the continuity-based CMLc/CMLt/AMLc/AMLt. Beats before
+// 5 seconds are ignored on both sides, as mir_eval does, since trackers need
+// a few bars to lock. Times are in seconds.
+namespace BeatEval {
+
+struct Annotations {
+    std::vector<double> beats;
+    std::vector<double> downbeats;
+};
+
+// One beat per line: "<time> [<position in bar>]"; position 1 marks a
+// downbeat. Blank lines and lines starting with '#' are skipped.
+inline bool loadAnnotations(const std::string &path, Annotations &out) {
+    std::ifstream f(path);
+    if (!f) return false;
+    std::string line;
+    while (std::getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream in(line);
+        double t;
+        if (!(in >> t)) continue;
+        out.beats.push_back(t);
+        double position;
+        if (in >> position && position == 1.0) out.downbeats.push_back(t);
+    }
+    return true;
+}
+
+inline std::vector<double> trim(const std::vector<double> &beats, double minTime = 5.0) {
+    std::vector<double> out;
+    for (double b : beats)
+        if (b >= minTime) out.push_back(b);
+    return out;
+}
+
+// One-to-one matches within +-window. Both lists sorted; greedy in time
+// order is a maximum matching for points on a line.
+inline int countMatches(const std::vector<double> &reference, const std::vector<double> &estimated, double window) {
+    int matches = 0;
+    size_t j = 0;
+    for (double r : reference) {
+        while (j < estimated.size() && estimated[j] < r - window) j++;
+        if (j < estimated.size() && estimated[j] <= r + window) {
+            matches++;
+            j++;
+        }
+    }
+    return matches;
+}
+
+inline double fMeasure(const std::vector<double> &reference, const std::vector<double> &estimated, double window = 0.07) {
+    std::vector<double> ref = trim(reference), est = trim(estimated);
+    if (ref.empty() || est.empty()) return 0.0;
+    double matches = countMatches(ref, est, window);
+    double precision = matches / est.size(), recall = matches / ref.size();
+    return precision + recall > 0 ? 2 * precision * recall / (precision + recall) : 0.0;
+}
+
+// Mean signed offset (estimated - reference) of the matched beats, seconds
+inline double meanOffset(const std::vector<double> &reference, const std::vector<double> &estimated, double window = 0.07) {
+    double sum = 0;
+    int n = 0;
+    size_t j = 0;
+    for (double r : trim(reference)) {
+        while (j < estimated.size() && estimated[j] < r - window) j++;
+        if (j < estimated.size() && estimated[j] <= r + window) {
+            sum += estimated[j] - r;
+            n++;
+            j++;
+        }
+    }
+    return n ? sum / n : 0.0;
+}
+
+struct Continuity {
+    double cmlc = 0, cmlt = 0, amlc = 0, amlt = 0;
+};
+
+// mir_eval.beat.continuity: a beat is correct when it is within
+// phaseThreshold of the nearest annotation's interval and its own interval
+// matches within periodThreshold. CML* score the annotated metrical level,
+// AML* the best of it, off-beat, double and both half-tempo variants;
+// *c counts the longest correct run, *t all correct beats.
+inline Continuity continuity(const std::vector<double> &reference, const std::vector<double> &estimated,
+                             double phaseThreshold = 0.175, double periodThreshold = 0.175) {
+    Continuity result;
+    std::vector<double> ref = trim(reference), est = trim(estimated);
+    if (ref.size() < 2 || est.size() < 2) return result;
+
+    std::vector<double> twice;
+    for (size_t i = 0; i < ref.size(); i++) {
+        twice.push_back(ref[i]);
+        if (i + 1 < ref.size()) twice.push_back(0.5 * (ref[i] + ref[i + 1]));
+    }
+    std::vector<std::vector<double>> variations(5);
+    variations[0] = ref;
+    for (size_t i = 1; i < twice.size(); i += 2) variations[1].push_back(twice[i]);
+    variations[2] = twice;
+    for (size_t i = 0; i < ref.size(); i += 2) variations[3].push_back(ref[i]);
+    for (size_t i = 1; i < ref.size(); i += 2) variations[4].push_back(ref[i]);
+
+    for (size_t v = 0; v < variations.size(); v++) {
+        const std::vector<double> &r = variations[v];
+        if (r.size() < 2) continue;
+        size_t n = std::max(r.size(), est.size());
+        std::vector<char> used(r.size(), 0), ok(n, 0);
+        for (size_t m = 0; m < est.size(); m++) {
+            size_t nearest = 0;
+            for (size_t k = 1; k < r.size(); k++)
+                if (std::abs(est[m] - r[k]) < std::abs(est[m] - r[nearest])) nearest = k;
+            if (used[nearest]) continue;
+            double diff = std::abs(est[m] - r[nearest]);
+            double refInterval, estInterval;
+            if (m == 0 || nearest == 0) {
+                // Look forward from the first beat or annotation
+                refInterval = nearest + 1 < r.size() ? r[nearest + 1] - r[nearest] : r[nearest] - r[nearest - 1];
+                estInterval = m + 1 < est.size() ? est[m + 1] - est[m] : est[m] - est[m - 1];
+            } else {
+                refInterval = r[nearest] - r[nearest - 1];
+                estInterval = est[m] - est[m - 1];
+            }
+            if (refInterval <= 0) continue;
+            double phase = diff / refInterval;
+            double period = std::abs(1.0 - estInterval / refInterval);
+            if (phase < phaseThreshold && period < periodThreshold) {
+                used[nearest] = 1;
+                ok[m] = 1;
+            }
+        }
+        size_t total = 0, run = 0, longest = 0;
+        for (char c : ok) {
+            total += c;
+            run = c ? run + 1 : 0;
+            longest = std::max(longest, run);
+        }
+        double c = (double)longest / n, t = (double)total / n;
+        if (v == 0) {
+            result.cmlc = c;
+            result.cmlt = t;
+        }
+        result.amlc = std::max(result.amlc, c);
+        result.amlt = std::max(result.amlt, t);
+    }
+    return result;
+}
+
+} // namespace BeatEval
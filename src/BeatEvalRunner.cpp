@@ -0,0 +1,218 @@
+#include "BeatEvalRunner.h"
+#include "BeatTracker.h"
+#include "WavReader.h"
+#include "Timebase.h"
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+bool BeatEvalRunner::parseArgs(const vector<string> &args)
+{
+    bool valid = true;
+    for (size_t i = 0; i < args.size(); i++) {
+        const string &a = args[i];
+        bool hasValue = i + 1 < args.size();
+        try {
+            if (a == "--beat-eval") {
+                while (i + 1 < args.size() && args[i + 1].rfind("--", 0) != 0) inputs.push_back(args[++i]);
+            } else if (a == "--annotations" && hasValue) {
+                annotationDir = args[++i];
+            } else if (a == "--report" && hasValue) {
+                reportPath = args[++i];
+            } else if (a == "--min-f" && hasValue) {
+                minF = std::stod(args[++i]);
+            } else if (a == "--latency-budget" && hasValue) {
+                latencyBudgetMs = std::stof(args[++i]);
+            } else if (a == "--block" && hasValue) {
+                blockFrames = std::max(1, std::stoi(args[++i]));
+            }
+        } catch (const std::exception &) {
+            ofLogError("BeatEval") << "Invalid value for " << a << ": " << args[i];
+            valid = false;
+        }
+    }
+    if (!valid || inputs.empty()) {
+        ofLogError("BeatEval") << "Usage: --beat-eval <file.wav|dir>... [--annotations DIR] [--report FILE.json] [--min-f F] [--latency-budget MS] [--block FRAMES]";
+        return false;
+    }
+    return true;
+}
+
+vector<string> BeatEvalRunner::collectFiles() const
+{
+    vector<string> files;
+    for (auto &in : inputs) {
+        std::error_code ec;
+        if (fs::is_directory(in, ec)) {
+            for (auto &e : fs::directory_iterator(in, ec)) {
+                string ext = e.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (e.is_regular_file() && ext == ".wav") files.push_back(e.path().string());
+            }
+        } else {
+            files.push_back(in);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+string BeatEvalRunner::findAnnotations(const string &wavPath) const
+{
+    fs::path p(wavPath);
+    fs::path dir = annotationDir.empty() ? p.parent_path() : fs::path(annotationDir);
+    for (const char *ext : {".beats", ".txt"}) {
+        fs::path candidate = dir / (p.stem().string() + ext);
+        if (fs::exists(candidate)) return candidate.string();
+    }
+    return "";
+}
+
+bool BeatEvalRunner::analyse(const string &path, FileResult &out)
+{
+    WavData wav;
+    string error;
+    if (!WavReader::load(path, wav, error)) {
+        ofLogError("BeatEval") << path << ": " << error;
+        return false;
+    }
+
+    BeatTracker tracker;
+    tracker.setInputRate(wav.sampleRate);
+    tracker.setEnabled(true);
+    tracker.setLatencyBudgetMs(latencyBudgetMs);
+    tracker.setup(false);
+
+    out.name = fs::path(path).filename().string();
+    out.duration = wav.getDuration();
+
+    // The stream position is the clock: a block's capture time is the end of
+    // its last sample, so beat times come out in seconds into the file
+    ofSoundBuffer buffer;
+    buffer.allocate(blockFrames, wav.channels);
+    buffer.setSampleRate(wav.sampleRate);
+    size_t total = wav.getNumFrames();
+    double latencySum = 0;
+    BeatTracker::Beat beats[64];
+    int64_t start = Timebase::nowNs();
+    for (size_t pos = 0; pos < total; pos += blockFrames) {
+        size_t n = std::min((size_t)blockFrames, total - pos);
+        if (n < (size_t)blockFrames) buffer.allocate(n, wav.channels);
+        std::copy(wav.samples.begin() + pos * wav.channels, wav.samples.begin() + (pos + n) * wav.channels, buffer.getBuffer().begin());
+        int64_t endNs = (int64_t)(pos + n) * Timebase::NS_PER_SEC / wav.sampleRate;
+        tracker.audioIn(buffer, endNs);
+        tracker.process();
+
+        size_t got;
+        while ((got = tracker.popBeats(beats, 64)) > 0) {
+            for (size_t i = 0; i < got; i++) {
+                double t = Timebase::toSeconds(beats[i].timeNs);
+                out.beats.push_back(t);
+                if (beats[i].downbeat) out.downbeats.push_back(t);
+                latencySum += Timebase::toMillis(endNs - beats[i].timeNs);
+                out.finalBpm = beats[i].bpm;
+            }
+        }
+    }
+    out.wallSeconds = Timebase::toSeconds(Timebase::nowNs() - start);
+    out.meanEmitLatencyMs = out.beats.empty() ? 0 : latencySum / out.beats.size();
+    out.frontEndUs = tracker.getFrontEndLatency().p50;
+    out.inferenceUs = tracker.getInferenceLatency().p50;
+    out.decoderUs = tracker.getDecoderLatency().p50;
+
+    string annotationPath = findAnnotations(path);
+    BeatEval::Annotations ann;
+    if (!annotationPath.empty() && BeatEval::loadAnnotations(annotationPath, ann)) {
+        out.annotated = true;
+        out.f = BeatEval::fMeasure(ann.beats, out.beats);
+        out.downbeatF = BeatEval::fMeasure(ann.downbeats, out.downbeats);
+        out.offsetMs = 1000.0 * BeatEval::meanOffset(ann.beats, out.beats);
+        out.continuity = BeatEval::continuity(ann.beats, out.beats);
+    }
+    return true;
+}
+
+int BeatEvalRunner::run(const vector<string> &args)
+{
+    if (!parseArgs(args)) return 2;
+    vector<string> files = collectFiles();
+    if (files.empty()) {
+        ofLogError("BeatEval") << "No WAV files found";
+        return 2;
+    }
+
+    ofJson report;
+    report["files"] = ofJson::array();
+    bool failed = false;
+    int scored = 0;
+    double sumF = 0, sumDownF = 0, sumCmlt = 0, sumAmlt = 0, audioSeconds = 0, wallSeconds = 0;
+
+    for (auto &path : files) {
+        FileResult r;
+        if (!analyse(path, r)) {
+            failed = true;
+            continue;
+        }
+        audioSeconds += r.duration;
+        wallSeconds += r.wallSeconds;
+
+        ofJson j;
+        j["file"] = r.name;
+        j["duration"] = r.duration;
+        j["beats"] = r.beats;
+        j["downbeats"] = r.downbeats;
+        j["bpm"] = r.finalBpm;
+        j["realtimeFactor"] = r.wallSeconds > 0 ? r.duration / r.wallSeconds : 0.0;
+        j["emitLatencyMs"] = r.meanEmitLatencyMs;
+        j["stageUs"] = {{"frontEnd", r.frontEndUs}, {"inference", r.inferenceUs}, {"decoder", r.decoderUs}};
+
+        string line = r.name + ": " + ofToString(r.beats.size()) + " beats, " + ofToString(r.finalBpm, 1) + " BPM, x" +
+                      ofToString(r.wallSeconds > 0 ? r.duration / r.wallSeconds : 0.0, 1) + " realtime, emit latency " +
+                      ofToString(r.meanEmitLatencyMs, 1) + " ms, p50 us front-end/inference/decoder " +
+                      ofToString(r.frontEndUs, 0) + "/" + ofToString(r.inferenceUs, 0) + "/" + ofToString(r.decoderUs, 0);
+        if (r.annotated) {
+            j["f"] = r.f;
+            j["downbeatF"] = r.downbeatF;
+            j["cmlc"] = r.continuity.cmlc;
+            j["cmlt"] = r.continuity.cmlt;
+            j["amlc"] = r.continuity.amlc;
+            j["amlt"] = r.continuity.amlt;
+            j["offsetMs"] = r.offsetMs;
+            line += ", F " + ofToString(r.f, 3) + ", downbeat F " + ofToString(r.downbeatF, 3) + ", CMLt " +
+                    ofToString(r.continuity.cmlt, 3) + ", AMLt " + ofToString(r.continuity.amlt, 3) + ", offset " +
+                    ofToString(r.offsetMs, 1) + " ms";
+            sumF += r.f;
+            sumDownF += r.downbeatF;
+            sumCmlt += r.continuity.cmlt;
+            sumAmlt += r.continuity.amlt;
+            scored++;
+        } else {
+            line += ", no annotations";
+        }
+        ofLogNotice("BeatEval") << line;
+        report["files"].push_back(j);
+    }
+
+    ofJson summary;
+    summary["files"] = (int)files.size();
+    summary["scored"] = scored;
+    summary["realtimeFactor"] = wallSeconds > 0 ? audioSeconds / wallSeconds : 0.0;
+    if (scored > 0) {
+        summary["f"] = sumF / scored;
+        summary["downbeatF"] = sumDownF / scored;
+        summary["cmlt"] = sumCmlt / scored;
+        summary["amlt"] = sumAmlt / scored;
+        ofLogNotice("BeatEval") << "Mean of " << scored << " files: F " << ofToString(sumF / scored, 3) << ", downbeat F "
+                                << ofToString(sumDownF / scored, 3) << ", CMLt " << ofToString(sumCmlt / scored, 3)
+                                << ", AMLt " << ofToString(sumAmlt / scored, 3);
+    }
+    report["summary"] = summary;
+    // Absolute, or ofSaveJson would put it under bin/data
+    if (!reportPath.empty()) ofSaveJson(fs::absolute(reportPath).string(), report);
+
+    if (minF >= 0 && (scored == 0 || sumF / scored < minF)) {
+        ofLogError("BeatEval") << "Mean F-measure below " << minF;
+        failed = true;
+    }
+    return failed ? 1 : 0;
+}
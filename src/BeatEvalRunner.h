@@ -0,0 +1,46 @@
+#pragma once
+#include "ofMain.h"
+#include "BeatEval.h"
+
+// Headless accuracy/performance run of the beat tracker (--beat-eval).
+// WAV files are streamed through the same audioIn -> spectrogram -> ONNX ->
+// particle filter path as live input, as fast as the CPU allows, using the
+// audio position as the clock. Beats are scored against annotation files
+// with the same stem (song.wav -> song.beats or song.txt).
+//
+//   invasiv --beat-eval <file.wav|dir>... [--annotations DIR] [--report FILE.json]
+//           [--min-f F] [--latency-budget MS] [--block FRAMES]
+//
+// Returns non-zero if a file fails to load or the mean F-measure is below
+// --min-f, so CI can gate on it.
+class BeatEvalRunner {
+public:
+    int run(const vector<string> &args);
+
+private:
+    struct FileResult {
+        string name;
+        double duration = 0;
+        double wallSeconds = 0;
+        vector<double> beats;
+        vector<double> downbeats;
+        double meanEmitLatencyMs = 0;
+        double finalBpm = 0;
+        float frontEndUs = 0, inferenceUs = 0, decoderUs = 0; // p50 per hop
+        bool annotated = false;
+        double f = 0, downbeatF = 0, offsetMs = 0;
+        BeatEval::Continuity continuity;
+    };
+
+    vector<string> inputs;
+    string annotationDir;
+    string reportPath;
+    double minF = -1;
+    float latencyBudgetMs = 0;
+    int blockFrames = 512;
+
+    bool parseArgs(const vector<string> &args);
+    vector<string> collectFiles() const;
+    bool analyse(const string &path, FileResult &out);
+    string findAnnotations(const string &wavPath) const;
+};
@@ -0,0 +1,290 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Online beat/downbeat decoder for the network's activations, after BeatNet's
+// two-stage inference:
+//  - a particle filter over (beat phase, tempo) follows the beats. Every hop
+//    each particle advances by its tempo, is weighted by how well the
+//    activations fit its phase, and the population is resampled when the
+//    weights degenerate.
+//  - at each beat it reports, a small exact filter over (meter, beat in bar)
+//    is advanced and weighted with the downbeat activation around that beat.
+// Splitting the bar level out keeps the particles dense where it matters:
+// 1500 particles cover the tempo/phase plane finely, where a joint
+// (phase, tempo, bar position, meter) space would leave most hypotheses
+// unsampled.
+//
+// Particles are stored as parallel arrays (structure of arrays) so the
+// per-hop predict and weight loops run branch-free over contiguous floats.
+// Randomness only enters at beat crossings (tempo changes) and resampling.
+class BeatParticleFilter {
+public:
+    static constexpr int MAX_METER = 8;
+
+    struct Params {
+        int numParticles = 1500;
+        float minBpm = 55.0f;
+        float maxBpm = 215.0f;
+        int minMeter = 3;
+        int maxMeter = 4;
+        // Beat region is 1 / lambda of a beat, centred on the beat, as in
+        // madmom's observation model; outside it the non-beat probability is
+        // spread out
+        float lambda = 16.0f;
+        // Std-dev of the relative tempo change at each beat
+        float tempoSigma = 0.02f;
+        // Resample when the effective sample size drops below this share
+        float resampleThreshold = 0.5f;
+        // Share of particles redrawn over the whole tempo/phase plane at each
+        // resample, so the filter can find a new tempo after a change
+        float reseed = 0.01f;
+        // Bar level: evidence a beat gets for being a downbeat when the
+        // network says plain beat (or vice versa), and the chance per beat of
+        // jumping to another bar position or meter
+        float meterSlack = 0.25f;
+        float barJump = 0.02f;
+        uint64_t seed = 0x9E3779B97F4A7C15ull;
+    };
+
+    struct Result {
+        bool beat = false;
+        bool downbeat = false;
+        int beatInBar = 0;       // 0 = downbeat
+        float beatOffset = 0.0f; // how far past the beat this hop is, in hops
+        float bpm = 0.0f;
+        int meter = 4;
+        float confidence = 0.0f; // 0..1, agreement of the particles on the beat phase
+    };
+
+    explicit BeatParticleFilter(double hopSeconds = 441.0 / 22050.0) : BeatParticleFilter(hopSeconds, Params()) {}
+    BeatParticleFilter(double hopSeconds, const Params &p) : params(p), hopSec(hopSeconds) {
+        params.minMeter = std::max(1, std::min(MAX_METER, params.minMeter));
+        params.maxMeter = std::max(params.minMeter, std::min(MAX_METER, params.maxMeter));
+        reset();
+    }
+
+    // Spreads the particles evenly over log-tempo and phase, and the bar
+    // filter uniformly over meters and positions
+    void reset() {
+        const int n = params.numParticles;
+        phase.resize(n);
+        step.resize(n);
+        weight.assign(n, 1.0f / n);
+        crossed.resize(n);
+        scratch.resize(n);
+        for (auto &v : spare) v.resize(n);
+        rng = params.seed ? params.seed : 1;
+
+        int tempos = std::max(1, (int)std::sqrt(n * 2.5));
+        int phases = std::max(1, n / tempos);
+        for (int i = 0; i < n; i++) {
+            int t = (i / phases) % tempos, k = i % phases;
+            float bpm = params.minBpm * std::pow(params.maxBpm / params.minBpm, (t + 0.5f) / tempos);
+            step[i] = bpmToStep(bpm);
+            phase[i] = (k + 0.5f) / phases;
+        }
+
+        int states = 0;
+        for (int m = params.minMeter; m <= params.maxMeter; m++) states += m;
+        for (int m = 0; m <= MAX_METER; m++)
+            for (int k = 0; k < MAX_METER; k++) bar[m][k] = (m >= params.minMeter && m <= params.maxMeter && k < m) ? 1.0f / states : 0.0f;
+
+        lastPhase = 0.0f;
+        beatEvidence = downbeatEvidence = 0.0f;
+        current = Result();
+        current.bpm = 120.0f;
+        current.meter = params.maxMeter;
+    }
+
+    // One hop. beatAct/downbeatAct are the network's (exclusive) beat and
+    // downbeat probabilities for this frame.
+    const Result &update(float beatAct, float downbeatAct) {
+        predict();
+        weigh(beatAct + downbeatAct);
+        if (effectiveSize() < params.resampleThreshold * params.numParticles) resample();
+        estimate(beatAct, downbeatAct);
+        return current;
+    }
+
+    const Result &getResult() const { return current; }
+    int getNumParticles() const { return params.numParticles; }
+    double getHopSeconds() const { return hopSec; }
+
+private:
+    Params params;
+    double hopSec;
+    std::vector<float> phase;  // beat phase, [0, 1)
+    std::vector<float> step;   // tempo, beats per hop
+    std::vector<float> weight;
+    std::vector<uint8_t> crossed;
+    std::vector<float> scratch;
+    std::vector<float> spare[2]; // resampling targets, swapped with phase/step
+    float bar[MAX_METER + 1][MAX_METER]; // P(meter, beat in bar) at the last beat
+    uint64_t rng;
+    float lastPhase;
+    float beatEvidence, downbeatEvidence; // activation peaks since the last half beat
+    Result current;
+
+    float bpmToStep(float bpm) const { return (float)(bpm / 60.0 * hopSec); }
+    float stepToBpm(float s) const { return (float)(s * 60.0 / hopSec); }
+
+    // xorshift64*, enough for sampling and deterministic under a fixed seed
+    float uniform() {
+        rng ^= rng >> 12;
+        rng ^= rng << 25;
+        rng ^= rng >> 27;
+        return (float)((rng * 0x2545F4914F6CDD1Dull) >> 40) * (1.0f / 16777216.0f);
+    }
+
+    float gaussian() {
+        float u1 = std::max(uniform(), 1e-7f), u2 = uniform();
+        return std::sqrt(-2.0f * std::log(u1)) * std::cos(6.28318530718f * u2);
+    }
+
+    void predict() {
+        const int n = params.numParticles;
+        float *p = phase.data();
+        const float *s = step.data();
+        uint8_t *c = crossed.data();
+        for (int i = 0; i < n; i++) {
+            float next = p[i] + s[i];
+            c[i] = (uint8_t)(next >= 1.0f);
+            p[i] = next >= 1.0f ? next - 1.0f : next;
+        }
+        // Tempo may only change on a beat, so the walk is per beat, not per hop
+        const float lo = bpmToStep(params.minBpm), hi = bpmToStep(params.maxBpm);
+        for (int i = 0; i < n; i++) {
+            if (!c[i]) continue;
+            step[i] = std::min(hi, std::max(lo, step[i] * (1.0f + params.tempoSigma * gaussian())));
+        }
+    }
+
+    // act: probability of any beat (beat + downbeat) in this frame
+    void weigh(float act) {
+        const float floorProb = 1e-4f;
+        const float halfRegion = 0.5f / params.lambda;
+        const float onBeat = std::max(floorProb, act);
+        const float offBeat = std::max(floorProb, (1.0f - act) / (params.lambda - 1.0f));
+        const int n = params.numParticles;
+        const float *p = phase.data();
+        float *w = weight.data();
+        float sum = 0.0f;
+        for (int i = 0; i < n; i++) {
+            bool near = p[i] < halfRegion || p[i] > 1.0f - halfRegion;
+            w[i] *= near ? onBeat : offBeat;
+            sum += w[i];
+        }
+        if (!(sum > 0.0f)) {
+            std::fill(weight.begin(), weight.end(), 1.0f / n);
+            return;
+        }
+        const float inv = 1.0f / sum;
+        for (int i = 0; i < n; i++) w[i] *= inv;
+    }
+
+    float effectiveSize() const {
+        float sq = 0.0f;
+        for (float w : weight) sq += w * w;
+        return sq > 0.0f ? 1.0f / sq : 0.0f;
+    }
+
+    // Systematic resampling: one uniform offset, n evenly spaced pointers
+    // into the cumulative weights. O(n) and low variance.
+    void resample() {
+        const int n = params.numParticles;
+        std::vector<float> &cumulative = scratch;
+        float acc = 0.0f;
+        for (int i = 0; i < n; i++) cumulative[i] = acc += weight[i];
+        const float stride = acc / n;
+        float u = uniform() * stride;
+        float *newPhase = spare[0].data(), *newStep = spare[1].data();
+        int j = 0;
+        for (int i = 0; i < n; i++, u += stride) {
+            while (j < n - 1 && cumulative[j] < u) j++;
+            // Jitter within one hop: a frame only locates a beat to the nearest hop
+            float q = phase[j] + (uniform() - 0.5f) * step[j];
+            newPhase[i] = q < 0.0f ? q + 1.0f : (q >= 1.0f ? q - 1.0f : q);
+            newStep[i] = step[j];
+        }
+        const float lo = bpmToStep(params.minBpm), ratio = params.maxBpm / params.minBpm;
+        int fresh = (int)(params.reseed * n);
+        for (int i = 0; i < fresh; i++) {
+            int k = (int)(uniform() * n) % n;
+            newPhase[k] = uniform();
+            newStep[k] = lo * std::pow(ratio, uniform());
+        }
+        phase.swap(spare[0]);
+        step.swap(spare[1]);
+        std::fill(weight.begin(), weight.end(), 1.0f / n);
+    }
+
+    // Advances the bar filter by one beat and weights it with the activation
+    // peaks around that beat
+    void barStep() {
+        float next[MAX_METER + 1][MAX_METER] = {};
+        int states = 0;
+        for (int m = params.minMeter; m <= params.maxMeter; m++) states += m;
+        const float slack = params.meterSlack * (beatEvidence + downbeatEvidence);
+        const float onDownbeat = downbeatEvidence + slack + 1e-4f;
+        const float onBeat = beatEvidence + slack + 1e-4f;
+        float sum = 0.0f;
+        for (int m = params.minMeter; m <= params.maxMeter; m++) {
+            for (int k = 0; k < m; k++) {
+                float p = (1.0f - params.barJump) * bar[m][(k + m - 1) % m] + params.barJump / states;
+                next[m][k] = p * (k == 0 ? onDownbeat : onBeat);
+                sum += next[m][k];
+            }
+        }
+        for (int m = params.minMeter; m <= params.maxMeter; m++)
+            for (int k = 0; k < m; k++) bar[m][k] = next[m][k] / sum;
+    }
+
+    // Point estimate: weighted circular mean of the beat phase (its resultant
+    // length is the confidence) and mean tempo. A beat is reported when the
+    // mean phase wraps; the bar filter then gives meter and position.
+    void estimate(float beatAct, float downbeatAct) {
+        const int n = params.numParticles;
+        const float twoPi = 6.28318530718f;
+        float c = 0.0f, s = 0.0f, tempo = 0.0f;
+        for (int i = 0; i < n; i++) {
+            c += weight[i] * std::cos(twoPi * phase[i]);
+            s += weight[i] * std::sin(twoPi * phase[i]);
+            tempo += weight[i] * step[i];
+        }
+        float mean = std::atan2(s, c) / twoPi;
+        if (mean < 0.0f) mean += 1.0f;
+
+        // Collect the activation peaks from half a beat before each beat
+        if (mean >= 0.5f && lastPhase < 0.5f) beatEvidence = downbeatEvidence = 0.0f;
+        beatEvidence = std::max(beatEvidence, beatAct);
+        downbeatEvidence = std::max(downbeatEvidence, downbeatAct);
+
+        current.bpm = stepToBpm(tempo);
+        current.confidence = std::sqrt(c * c + s * s);
+        current.beat = mean < lastPhase - 0.5f;
+        current.beatOffset = tempo > 0.0f ? mean / tempo : 0.0f;
+        lastPhase = mean;
+        if (!current.beat) return;
+
+        barStep();
+        float bestMeter = -1.0f, best = -1.0f;
+        for (int m = params.minMeter; m <= params.maxMeter; m++) {
+            float meterProb = 0.0f;
+            for (int k = 0; k < m; k++) meterProb += bar[m][k];
+            if (meterProb > bestMeter) {
+                bestMeter = meterProb;
+                current.meter = m;
+            }
+        }
+        for (int k = 0; k < current.meter; k++) {
+            if (bar[current.meter][k] > best) {
+                best = bar[current.meter][k];
+                current.beatInBar = k;
+            }
+        }
+        current.downbeat = current.beatInBar == 0;
+    }
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include "Metronome.h"
+#include "Timebase.h"
+
+enum Quantize : uint8_t {
+    QUANTIZE_NONE = 0,
+    QUANTIZE_BEAT = 1,
+    QUANTIZE_BAR  = 2
+};
+
+// Runs actions at a cluster time, usually a beat or bar boundary picked with
+// quantize(). schedule() is lock-free and may be called from any thread
+// (key handler, GUI, packet handler); update() runs on the frame loop and
+// fires everything that is due, oldest target first.
+//
+// The hand-off is a bounded multi-producer ring (one sequence counter per
+// slot, Vyukov style); the consumer moves entries into a time-sorted list it
+// owns, so no lock is ever shared between producers and the frame loop.
+class BeatScheduler {
+public:
+    typedef std::function<void()> Action;
+    static const size_t CAPACITY = 64; // power of two
+
+    // Time left before the target beat for the network fan-out and for
+    // peers to preload the content it needs
+    int64_t lookaheadNs = 150 * Timebase::NS_PER_MS;
+
+    BeatScheduler() {
+        for (size_t i = 0; i < CAPACITY; i++) slots[i].seq.store(i, std::memory_order_relaxed);
+        waiting.reserve(CAPACITY);
+    }
+
+    // First beat/bar boundary at least lookaheadNs after nowNs. Beat 0 of the
+    // metronome starts a bar.
+    static int64_t quantize(const Metronome &m, Quantize q, int64_t nowNs, int64_t lookaheadNs) {
+        int64_t earliest = nowNs + lookaheadNs;
+        if (q == QUANTIZE_NONE || m.bpm <= 0) return earliest;
+        double grid = (q == QUANTIZE_BAR) ? std::max(1, m.beatsPerBar) : 1;
+        double beat = m.getBeatAt(earliest);
+        double target = std::ceil(beat / grid - 1e-9) * grid;
+        return m.getTimeOfBeat(target);
+    }
+
+    int64_t nextBoundary(const Metronome &m, Quantize q) const {
+        return quantize(m, q, m.nowNs(), lookaheadNs);
+    }
+
+    // Returns false if the queue is full
+    bool schedule(int64_t atNs, Action fn) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        Slot *s;
+        for (;;) {
+            s = &slots[pos & (CAPACITY - 1)];
+            size_t seq = s->seq.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+            if (dif == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (dif < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        s->atNs = atNs;
+        s->fn = std::move(fn);
+        s->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Fires every action due at nowNs. Single consumer. Returns the count fired.
+    int update(int64_t nowNs) {
+        drain();
+        int fired = 0;
+        while (!waiting.empty() && waiting.front().atNs <= nowNs) {
+            Action fn = std::move(waiting.front().fn);
+            waiting.erase(waiting.begin());
+            if (fn) fn();
+            fired++;
+        }
+        return fired;
+    }
+
+    // Drops everything queued. Consumer side only.
+    void clear() {
+        drain();
+        waiting.clear();
+    }
+
+    size_t getPendingCount() const { return waiting.size(); }
+    int64_t getNextTargetNs() const { return waiting.empty() ? 0 : waiting.front().atNs; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq;
+        int64_t atNs = 0;
+        Action fn;
+    };
+
+    struct Entry {
+        int64_t atNs;
+        Action fn;
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<size_t> tail{0};
+    size_t head = 0;
+    std::vector<Entry> waiting; // sorted by atNs, FIFO among equal targets
+
+    void drain() {
+        for (;;) {
+            Slot &s = slots[head & (CAPACITY - 1)];
+            if (s.seq.load(std::memory_order_acquire) != head + 1) break;
+            Entry e{s.atNs, std::move(s.fn)};
+            s.fn = nullptr;
+            s.seq.store(head + CAPACITY, std::memory_order_release);
+            head++;
+            auto it = std::upper_bound(waiting.begin(), waiting.end(), e.atNs,
+                                       [](int64_t t, const Entry &x) { return t < x.atNs; });
+            waiting.insert(it, std::move(e));
+        }
+    }
+};
@@ -1,10 +1,11 @@
 #include "BeatTracker.h"
 #include <cmath>
 #include <algorithm>
+#include <cstring>
 
 BeatTracker::BeatTracker() {
     currentBpm.store(120.0f);
-    lastBeatTime.store(0.0f);
+    lastBeatTimeNs.store(0);
     isRunning.store(false);
     isEnabled.store(false);
 }
@@ -18,35 +19,57 @@ BeatTracker::~BeatTracker() {
     if (ortSession) delete ortSession;
     if (ortEnv) delete ortEnv;
     
-    if (fftCfg) kiss_fftr_free(fftCfg);
+    if (fftCfg) kiss_fft_free(fftCfg);
 }
 
-void BeatTracker::setup() {
+void BeatTracker::setup(bool threaded) {
     // 1. Setup DSP
-    fftCfg = kiss_fftr_alloc(winLength, 0, NULL, NULL);
+    fftCfg = kiss_fft_alloc(winLength, 0, NULL, NULL);
     windowFunc.resize(winLength);
     // Hanning window
     for (int i = 0; i < winLength; ++i) {
         windowFunc[i] = 0.5f * (1.0f - cos(2.0f * PI * i / (winLength - 1)));
     }
     
-    // Create simplistic log filterbank (30Hz to 17000Hz, 136 bands)
-    filterbank.resize(numBands, std::vector<float>(winLength / 2 + 1, 0.0f));
-    float minLogFreq = log10(30.0f);
-    float maxLogFreq = log10(17000.0f);
-    
-    for (int b = 0; b < numBands; ++b) {
-        float fCenter = pow(10.0f, minLogFreq + (maxLogFreq - minLogFreq) * (float)b / (numBands - 1));
-        // Find bin
-        int bin = (fCenter / (sampleRate / 2.0f)) * (winLength / 2);
-        if (bin >= 0 && bin <= winLength / 2) {
-            filterbank[b][bin] = 1.0f; // Simplified: just map 1-to-1 to nearest bin instead of triangle
-        }
+    // Same triangular log filterbank the model was trained on (madmom's
+    // LogarithmicFilterbank over the first winLength / 2 bins)
+    int numBins = winLength / 2;
+    filterbank = SparseFilterbank::logarithmic(SparseFilterbank::fftFrequencies(numBins, sampleRate), 24, 30.0, 17000.0, 440.0, true);
+    if (filterbank.getNumBands() != numBands) {
+        ofLogWarning("BeatTracker") << "Filterbank has " << filterbank.getNumBands() << " bands, model expects " << numBands;
+        numBands = filterbank.getNumBands();
     }
     
-    prevSpectrogram.resize(numBands, 0.0f);
+    prevSpectrogram.assign(numBands, 0.0f);
+    fftIn.assign(winLength, kiss_fft_cpx{0.0f, 0.0f});
+    fftOut.resize(winLength);
+    magnitudes.assign(numBins, 0.0f);
+    bandEnergy.assign(numBands, 0.0f);
+    featureSize = numBands * 2;
+    batchFeatures.assign(maxBatchFrames * featureSize, 0.0f);
+    frameTimes.assign(maxBatchFrames, 0);
+    modelOut.assign(3 * maxBatchFrames, 0.0f);
+    const int layers = 2, hiddenSize = 150;
+    for (auto &buf : lstmState)
+        for (auto &v : buf) v.assign(layers * hiddenSize, 0.0f);
+
+    particleFilter = BeatParticleFilter((double)hopLength / sampleRate);
+
+    // ~1.5s of audio; buffers are sized here so the audio callback never allocates
+    audioRing.reset(32768);
+    stampRing.reset(256);
+    monoScratch.resize(4096);
+    if (inputRate.load() == 0) configureInput(sampleRate);
     
-    // 2. Start processing thread (ONNX is loaded asynchronously inside)
+    analysisFrame.assign(winLength, 0.0f);
+    beatEvents.reset(64);
+
+    // 2. Start processing thread (ONNX is loaded asynchronously inside).
+    // Offline callers load it here and drive the analysis with process().
+    if (!threaded) {
+        loadModel();
+        return;
+    }
     isRunning.store(true);
     processingThread = std::thread(&BeatTracker::processingThreadFunc, this);
 }
@@ -59,11 +82,16 @@ void BeatTracker::drawDebug(int x, int y) {
     ofSetColor(255);
     ofDrawBitmapString("BeatTracker", x, y);
     ofDrawBitmapString("BPM: " + ofToString(currentBpm.load()), x, y + 20);
-    ofDrawBitmapString("Last Beat: " + ofToString(lastBeatTime.load()), x, y + 40);
+    ofDrawBitmapString("Last Beat: " + ofToString(Timebase::toSeconds(lastBeatTimeNs.load()), 3) + (lastBeatDownbeat.load() ? " (1)" : ""), x, y + 40);
+    ofDrawBitmapString("Meter " + ofToString(meter.load()) + "/4, conf " + ofToString(confidence.load(), 2), x, y + 60);
+    LatencyStats::Summary lat = getInferenceLatency();
+    ofDrawBitmapString("Inference p50/p99: " + ofToString(lat.p50, 0) + "/" + ofToString(lat.p99, 0) + " us", x, y + 80);
+    ofDrawBitmapString("Batch: " + ofToString(getBatchFrames()) + ", latency " + ofToString(getPipelineLatencyMs(), 1) + " ms", x, y + 100);
+    ofDrawBitmapString("Overruns: " + ofToString(getOverrunCount()), x, y + 120);
     
     // Draw activation history
     ofPushMatrix();
-    ofTranslate(x, y + 60);
+    ofTranslate(x, y + 130);
     ofSetColor(100);
     ofDrawRectangle(0, 0, 200, 50);
     ofSetColor(255, 0, 0);
@@ -79,61 +107,82 @@ void BeatTracker::drawDebug(int x, int y) {
 }
 
 void BeatTracker::audioIn(ofSoundBuffer& input) {
-    if (!isEnabled.load()) return;
+    // The callback runs once the device buffer is full, so "now" is when its
+    // last sample was captured
+    audioIn(input, Timebase::nowNs());
+}
+
+void BeatTracker::setInputRate(int rate) {
+    configureInput(rate);
+}
+
+void BeatTracker::configureInput(int rate) {
+    if (rate <= 0) return;
+    resampler.setup(rate, sampleRate, monoScratch.empty() ? 4096 : monoScratch.size());
+    resampledScratch.resize(resampler.maxOutput(monoScratch.empty() ? 4096 : monoScratch.size()));
+    inputRate.store(rate);
+    levels.setSampleRate(rate);
+    if (rate != sampleRate) ofLogNotice("BeatTracker") << "Resampling input from " << rate << " Hz to " << sampleRate << " Hz";
+}
+
+void BeatTracker::audioIn(ofSoundBuffer& input, int64_t captureNs) {
+    size_t channels = input.getNumChannels();
+    size_t frames = input.getNumFrames();
+    if (channels == 0 || monoScratch.empty()) return;
+    int rate = input.getSampleRate() > 0 ? (int)input.getSampleRate() : sampleRate;
+    if (rate != inputRate.load()) configureInput(rate); // allocates, only when the device changes
+    bool enabled = isEnabled.load();
+    // Don't filter across the gap while disabled
+    if (enabled && !wasEnabled) resampler.reset();
+    wasEnabled = enabled;
     
-    // Push audio to lock-free or mutex queue
-    std::lock_guard<std::mutex> lock(audioMutex);
-    for (size_t i = 0; i < input.getNumFrames(); ++i) {
-        // Mix down to mono
-        float mono = 0.0f;
-        for (size_t c = 0; c < input.getNumChannels(); ++c) {
-            mono += input.getSample(i, c);
-        }
-        mono /= input.getNumChannels();
-        audioBuffer.push_back(mono);
+    // Mix down to mono, apply the gain and meter it; when enabled, resample
+    // and hand the blocks to the analysis thread. Wait-free: if the ring is
+    // full the rest of the block is dropped and counted as an overrun.
+    const float *src = input.getBuffer().data();
+    const float gain = inputGain.load();
+    size_t written = 0, produced = 0;
+    for (size_t start = 0; start < frames; start += monoScratch.size()) {
+        size_t n = std::min(monoScratch.size(), frames - start);
+        downmix(src + start * channels, monoScratch.data(), n, channels);
+        if (gain != 1.0f)
+            for (size_t i = 0; i < n; ++i) monoScratch[i] *= gain;
+        levels.process(monoScratch.data(), n);
+        if (!enabled) continue;
+        size_t out = resampler.process(monoScratch.data(), n, resampledScratch.data(), resampledScratch.size());
+        produced += out;
+        written += audioRing.write(resampledScratch.data(), out);
     }
+    if (written == 0) return;
+    samplesWritten += written;
+
+    // The newest resampled sample trails the newest captured one by the
+    // filter delay, and samples dropped on overrun are the newest ones
+    int64_t lagNs = (int64_t)(resampler.getOutputLag() * Timebase::NS_PER_SEC / rate);
+    int64_t dropped = (int64_t)(produced - written);
+    AudioStamp captured = {samplesWritten, captureNs - lagNs - dropped * Timebase::NS_PER_SEC / sampleRate};
+    stampRing.write(&captured, 1);
 }
 
-void BeatTracker::computeSpectrogram(const std::vector<float>& audioFrame, std::vector<float>& outSpectrogram) {
-    // 1. Apply window
-    std::vector<float> windowed(winLength, 0.0f);
-    int copyLen = std::min((int)audioFrame.size(), winLength);
-    for (int i = 0; i < copyLen; ++i) {
-        windowed[i] = audioFrame[i] * windowFunc[i];
-    }
+void BeatTracker::computeSpectrogram(const float *audioFrame, float *out) {
+    // 1. Apply window (imaginary parts stay zero)
+    for (int i = 0; i < winLength; ++i) fftIn[i].r = audioFrame[i] * windowFunc[i];
     
-    // 2. FFT
-    std::vector<kiss_fft_cpx> fftOut(winLength / 2 + 1);
-    kiss_fftr(fftCfg, windowed.data(), fftOut.data());
+    // 2. FFT. 1411 is odd, so the complex transform is used; only the first
+    // winLength / 2 bins are kept, as madmom does.
+    kiss_fft(fftCfg, fftIn.data(), fftOut.data());
     
     // 3. Magnitudes
-    std::vector<float> magnitudes(winLength / 2 + 1);
-    for (int i = 0; i < winLength / 2 + 1; ++i) {
-        magnitudes[i] = sqrt(fftOut[i].r * fftOut[i].r + fftOut[i].i * fftOut[i].i);
-    }
+    int numBins = (int)magnitudes.size();
+    SpectralOps::magnitudes((const float *)fftOut.data(), magnitudes.data(), numBins);
     
-    // 4. Log Mel Filterbank + Difference
-    outSpectrogram.resize(numBands * 2);
-    for (int b = 0; b < numBands; ++b) {
-        float bandMag = 0.0f;
-        for (int i = 0; i < winLength / 2 + 1; ++i) {
-            bandMag += magnitudes[i] * filterbank[b][i];
-        }
-        // Log scale
-        float logMag = log(1.0f + bandMag);
-        
-        // Difference
-        float diff = std::max(0.0f, logMag - prevSpectrogram[b]);
-        prevSpectrogram[b] = logMag;
-        
-        // Feature vector is concatenated [logMag, diff]
-        outSpectrogram[b] = logMag;
-        outSpectrogram[numBands + b] = diff;
-    }
+    // 4. Log filterbank + difference; feature vector is concatenated [logMag, diff]
+    filterbank.apply(magnitudes.data(), bandEnergy.data());
+    SpectralOps::logCompress(bandEnergy.data(), out, numBands);
+    SpectralOps::positiveDiff(out, prevSpectrogram.data(), out + numBands, numBands);
 }
 
-void BeatTracker::processingThreadFunc() {
-    // 1. Setup ONNX Runtime asynchronously
+void BeatTracker::loadModel() {
     try {
         ortEnv = new Ort::Env(ORT_LOGGING_LEVEL_WARNING, "BeatNet");
         Ort::SessionOptions sessionOptions;
@@ -143,129 +192,158 @@ void BeatTracker::processingThreadFunc() {
         std::string modelPath = ofToDataPath("models/beatnet.onnx", true);
         ortSession = new Ort::Session(*ortEnv, modelPath.c_str(), sessionOptions);
         ofLogNotice("BeatTracker") << "ONNX model loaded successfully: " << modelPath;
+        boundFrames = 1;
+        setupBindings(boundFrames);
     } catch (const Ort::Exception& e) {
         ofLogError("BeatTracker") << "Failed to load ONNX model: " << e.what();
+        delete ortSession;
+        ortSession = nullptr;
     }
+}
 
-    std::vector<float> frame(winLength, 0.0f);
-    
-    // LSTM states
-    std::vector<float> hidden(2 * 1 * 150, 0.0f);
-    std::vector<float> cell(2 * 1 * 150, 0.0f);
+void BeatTracker::processingThreadFunc() {
+    // 1. Setup ONNX Runtime asynchronously
+    loadModel();
     
     while (isRunning.load()) {
         if (!isEnabled.load()) {
+            skipInput();
             std::this_thread::sleep_for(std::chrono::milliseconds(50));
             continue;
         }
-
-        bool hasEnoughData = false;
-        {
-            std::lock_guard<std::mutex> lock(audioMutex);
-            if (audioBuffer.size() >= hopLength) {
-                hasEnoughData = true;
-                // Peek frame
-                int readLen = std::min((int)audioBuffer.size(), winLength);
-                for (int i = 0; i < readLen; ++i) {
-                    frame[i] = audioBuffer[i];
-                }
-                // Consume hop
-                for (int i = 0; i < hopLength; ++i) {
-                    audioBuffer.pop_front();
-                }
-            }
-        }
-        
-        if (hasEnoughData) {
-            std::vector<float> feats;
-            computeSpectrogram(frame, feats); // Size 272
-            
-            if (ortSession) {
-                // Prepare ONNX inputs
-                std::vector<int64_t> inputShape = {1, 1, 272};
-                std::vector<int64_t> hiddenShape = {2, 1, 150};
-                std::vector<int64_t> cellShape = {2, 1, 150};
-                
-                Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-                Ort::Value inputTensor = Ort::Value::CreateTensor<float>(memoryInfo, feats.data(), feats.size(), inputShape.data(), inputShape.size());
-                Ort::Value hiddenTensor = Ort::Value::CreateTensor<float>(memoryInfo, hidden.data(), hidden.size(), hiddenShape.data(), hiddenShape.size());
-                Ort::Value cellTensor = Ort::Value::CreateTensor<float>(memoryInfo, cell.data(), cell.size(), cellShape.data(), cellShape.size());
-                
-                std::vector<const char*> inputNames = {"input", "hidden_in", "cell_in"};
-                std::vector<Ort::Value> inputTensors;
-                inputTensors.push_back(std::move(inputTensor));
-                inputTensors.push_back(std::move(hiddenTensor));
-                inputTensors.push_back(std::move(cellTensor));
-                
-                std::vector<const char*> outputNames = {"output", "hidden_out", "cell_out"};
-                
-                try {
-                    auto outputTensors = ortSession->Run(Ort::RunOptions{nullptr}, inputNames.data(), inputTensors.data(), 3, outputNames.data(), 3);
-                    
-                    // output shape: (1, 3, 1) -> [beat_prob, downbeat_prob, non_beat_prob]
-                    float* outData = outputTensors[0].GetTensorMutableData<float>();
-                    float beatProb = outData[0];
-                    float downbeatProb = outData[1];
-                    
-                    // Update hidden and cell for next frame
-                    float* nextHidden = outputTensors[1].GetTensorMutableData<float>();
-                    float* nextCell = outputTensors[2].GetTensorMutableData<float>();
-                    std::copy(nextHidden, nextHidden + hidden.size(), hidden.begin());
-                    std::copy(nextCell, nextCell + cell.size(), cell.begin());
-                    
-                    updateParticleFilter(beatProb, downbeatProb);
-                    
-                    // Store for debug UI
-                    if (historyProb.size() > 100) historyProb.erase(historyProb.begin());
-                    historyProb.push_back(beatProb);
-                    
-                } catch (const Ort::Exception& e) {
-                    ofLogError("BeatTracker") << "ONNX Inference Error: " << e.what();
-                }
-            }
-        } else {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
-        }
+        wasDisabled = false;
+        if (!processHop()) std::this_thread::sleep_for(std::chrono::milliseconds(2));
     }
 }
 
-void BeatTracker::updateParticleFilter(float beatProb, float downbeatProb) {
-    // SIMPLIFIED PARTICLE FILTER / PEAK PICKER
-    // In a full implementation, this uses a formal Monte Carlo Particle Filter
-    // Here we use a simple peak-picking mechanism with a momentum buffer 
-    // to simulate the "lookahead" phase-locking discussed in beattracker.md.
-    
-    static float prevBeatProb = 0.0f;
-    static float lastTriggerTime = 0.0f;
-    static float currentExpectedInterval = 60.0f / 120.0f; // 120 BPM
+int BeatTracker::process() {
+    int hops = 0;
+    while (processHop()) hops++;
+    return hops;
+}
+
+void BeatTracker::skipInput() {
+    // Don't analyse stale audio when re-enabled
+    samplesRead += audioRing.discard(audioRing.readAvailable());
+    stampRing.discard(stampRing.readAvailable());
+    stamp = {samplesRead, 0};
+    pending = 0;
+    if (!wasDisabled) particleFilter.reset(); // the music may have changed
+    wasDisabled = true;
+}
+
+bool BeatTracker::processHop() {
+    // The frame is a sliding window over the newest winLength samples:
+    // each hop shifts it left and appends hopLength fresh samples.
+    if (audioRing.readAvailable() < (size_t)hopLength) return false;
+    std::memmove(analysisFrame.data(), analysisFrame.data() + hopLength, (winLength - hopLength) * sizeof(float));
+    audioRing.read(analysisFrame.data() + winLength - hopLength, hopLength);
+    samplesRead += hopLength;
+
+    // Capture time of the newest sample, from the latest callback stamp
+    // that covers it, then of the frame centre
+    while (stamp.endSample < samplesRead && stampRing.read(&stamp, 1) == 1) {}
+    int64_t endNs = stamp.ns ? stamp.ns + ((int64_t)samplesRead - (int64_t)stamp.endSample) * Timebase::NS_PER_SEC / sampleRate
+                             : Timebase::nowNs();
+    frameTimes[pending] = endNs - (int64_t)(winLength / 2) * Timebase::NS_PER_SEC / sampleRate;
+
+    int64_t start = Timebase::nowNs();
+    computeSpectrogram(analysisFrame.data(), batchFeatures.data() + pending * featureSize);
+    frontEndLatency.add(Timebase::nowNs() - start);
+    // Every other hop (25 fps) is plenty for the GUI's spectrum
+    if (hopCount++ % 2 == 0) levels.processBands(batchFeatures.data() + pending * featureSize, numBands);
+    pending++;
     
-    float now = ofGetElapsedTimef();
+    // Batch size only changes between batches, so no frame is lost
+    if (pending == 1) {
+        const double hopMs = 1000.0 * hopLength / sampleRate;
+        int wanted = std::max(1, std::min(maxBatchFrames, (int)(latencyBudgetMs.load() / hopMs) + 1));
+        batchFrames.store(wanted);
+    }
     
-    // Very simple peak picker
-    if (beatProb > 0.5f && prevBeatProb <= 0.5f) {
-        // We have a beat trigger!
-        // Calculate raw interval
-        float interval = now - lastTriggerTime;
+    if (!ortSession) {
+        pending = 0;
+        return true;
+    }
+    if (pending < batchFrames.load()) return true;
+
+    try {
+        if (pending != boundFrames) {
+            boundFrames = pending;
+            setupBindings(boundFrames);
+        }
+        runInference(pending);
+        pipelineLatencyMs.store((float)Timebase::toMillis(Timebase::nowNs() - frameTimes[pending - 1]));
         
-        // Ignore rapid double-triggers (e.g. bounce)
-        if (interval > 0.3f) { // Max ~200 BPM
-            // Lookahead Compensation: We assume the audio was buffered for ~50ms
-            // plus we subtract user latency offset
-            float triggerTimestamp = now - 0.05f - (latencyOffsetMs / 1000.0f);
-            
-            // Soft-sync BPM update (Phase-Locked Loop style)
-            if (interval < 1.5f) { // Min ~40 BPM
-                float rawBpm = 60.0f / interval;
-                float oldBpm = currentBpm.load();
-                // Exponential moving average (stubborn tempo enforcement)
-                float smoothedBpm = (oldBpm * 0.8f) + (rawBpm * 0.2f);
-                currentBpm.store(smoothedBpm);
-                currentExpectedInterval = 60.0f / smoothedBpm;
-            }
+        // Output is (1, 3, frames): row 0 beat, row 1 downbeat
+        start = Timebase::nowNs();
+        for (int t = 0; t < pending; ++t) {
+            float beatProb = modelOut[t];
+            updateParticleFilter(beatProb, modelOut[pending + t], frameTimes[t]);
             
-            lastTriggerTime = triggerTimestamp;
-            lastBeatTime.store(triggerTimestamp);
+            // Store for debug UI
+            if (historyProb.size() > 100) historyProb.erase(historyProb.begin());
+            historyProb.push_back(beatProb);
         }
+        decoderLatency.add((Timebase::nowNs() - start) / pending);
+        
+    } catch (const Ort::Exception& e) {
+        ofLogError("BeatTracker") << "ONNX Inference Error: " << e.what();
     }
-    prevBeatProb = beatProb;
+    pending = 0;
+    return true;
+}
+
+// Binds a (1, frames, featureSize) input so one Run advances the LSTM over
+// the whole batch. The recurrent state is kept across rebinds.
+void BeatTracker::setupBindings(int frames) {
+    const int layers = 2, hiddenSize = 150;
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    const int64_t inputShape[] = {1, frames, featureSize};
+    const int64_t stateShape[] = {layers, 1, hiddenSize};
+    const int64_t outputShape[] = {1, 3, frames}; // (batch, classes, time)
+    boundValues.clear();
+    boundValues.reserve(12);
+    auto tensor = [&](float *buf, size_t n, const int64_t *shape) -> Ort::Value & {
+        boundValues.push_back(Ort::Value::CreateTensor<float>(memoryInfo, buf, n, shape, 3));
+        return boundValues.back();
+    };
+    auto state = [&](std::vector<float> &buf) -> Ort::Value & { return tensor(buf.data(), buf.size(), stateShape); };
+
+    for (int p = 0; p < 2; ++p) {
+        bindings[p].reset(new Ort::IoBinding(*ortSession));
+        bindings[p]->BindInput("input", tensor(batchFeatures.data(), (size_t)frames * featureSize, inputShape));
+        bindings[p]->BindInput("hidden_in", state(lstmState[p][0]));
+        bindings[p]->BindInput("cell_in", state(lstmState[p][1]));
+        bindings[p]->BindOutput("output", tensor(modelOut.data(), (size_t)3 * frames, outputShape));
+        bindings[p]->BindOutput("hidden_out", state(lstmState[1 - p][0]));
+        bindings[p]->BindOutput("cell_out", state(lstmState[1 - p][1]));
+    }
+}
+
+void BeatTracker::runInference(int frames) {
+    int64_t start = Timebase::nowNs();
+    ortSession->Run(runOptions, *bindings[stateParity]);
+    // Per-frame cost, so batch sizes compare directly
+    inferenceLatency.add((Timebase::nowNs() - start) / frames);
+    // The state just written becomes the next step's input
+    stateParity = 1 - stateParity;
+}
+
+void BeatTracker::updateParticleFilter(float beatProb, float downbeatProb, int64_t frameTimeNs) {
+    const BeatParticleFilter::Result &r = particleFilter.update(beatProb, downbeatProb);
+    currentBpm.store(r.bpm);
+    meter.store(r.meter);
+    confidence.store(r.confidence);
+    if (!r.beat) return;
+
+    // Frame times come from the audio callback stamps, so device buffering
+    // and batching are already accounted for; the beat itself fell slightly
+    // before this frame, and the user's output offset is subtracted.
+    int64_t hopNs = (int64_t)hopLength * Timebase::NS_PER_SEC / sampleRate;
+    int64_t beatNs = frameTimeNs - (int64_t)(r.beatOffset * hopNs) - Timebase::fromMillis(latencyOffsetMs);
+    lastBeatDownbeat.store(r.downbeat);
+    lastBeatTimeNs.store(beatNs);
+    Beat beat = {beatNs, beatIndex++, r.bpm, r.confidence, (uint8_t)r.beatInBar, (uint8_t)r.meter, r.downbeat};
+    beatEvents.write(&beat, 1);
 }
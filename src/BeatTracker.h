@@ -3,74 +3,195 @@
 #include "ofMain.h"
 #include <thread>
 #include <atomic>
-#include <mutex>
 #include <vector>
-#include <deque>
+#include <memory>
 #include <onnxruntime_cxx_api.h>
-#include "kiss_fftr.h"
-
-// A simple Particle Filter state for tempo/phase tracking
-struct PFState {
-    float bpm = 120.0f;
-    float phase = 0.0f; // 0.0 to 1.0
-};
+#include "kiss_fft.h"
+#include "Timebase.h"
+#include "SpscRing.h"
+#include "SpectralFeatures.h"
+#include "Resampler.h"
+#include "LevelMeter.h"
+#include "LatencyStats.h"
+#include "BeatParticleFilter.h"
 
 class BeatTracker {
 public:
     BeatTracker();
     ~BeatTracker();
 
-    void setup();
+    // threaded = false loads the model on the calling thread and leaves the
+    // analysis to process(), e.g. for offline evaluation
+    void setup(bool threaded = true);
     void update();
     void drawDebug(int x, int y);
     
-    // Audio callback
+    // Audio callback. Any channel count and sample rate: blocks are mixed
+    // down and resampled to the model's 22050 Hz.
     void audioIn(ofSoundBuffer& input);
+    // captureNs: Timebase time at which the block's last sample was captured
+    void audioIn(ofSoundBuffer& input, int64_t captureNs);
+    // Offline mode only: analyses every complete hop fed so far, returns the hop count
+    int process();
+
+    struct Beat {
+        int64_t timeNs;    // Timebase ns, latency-compensated
+        uint64_t index;    // running count since setup
+        float bpm;
+        float confidence;
+        uint8_t beatInBar; // 0 = downbeat
+        uint8_t meter;
+        bool downbeat;
+    };
+    // Beats detected since the last call, oldest first. Single consumer.
+    size_t popBeats(Beat *out, size_t max) { return beatEvents.read(out, max); }
 
     // Getters for Metronome sync
     float getBPM() const { return currentBpm.load(); }
-    float getLastBeatTime() const { return lastBeatTime.load(); }
+    // Steady-clock ns (Timebase) of the last detected beat, latency-compensated
+    int64_t getLastBeatTimeNs() const { return lastBeatTimeNs.load(); }
+    int getMeter() const { return meter.load(); }
+    // 0..1, how well the particle filter agrees on the beat phase
+    float getConfidence() const { return confidence.load(); }
     
     void setLatencyOffset(float ms) { latencyOffsetMs = ms; }
     float getLatencyOffset() const { return latencyOffsetMs; }
     
+    int getSampleRate() const { return sampleRate; }
+    // Prepares the resampler for the capture rate so the first callbacks
+    // don't allocate. Call before the stream starts; a buffer at another rate
+    // still works, the resampler is rebuilt on the audio thread.
+    void setInputRate(int rate);
+    int getInputRate() const { return inputRate.load(); }
+    // Linear gain applied to the input before metering and analysis
+    void setInputGain(float gain) { inputGain.store(std::max(0.0f, gain)); }
+    float getInputGain() const { return inputGain.load(); }
+
+    // Level readings (every 20ms, whether or not the tracker is enabled) and
+    // band energies (while it is) since the last call. GUI thread only.
+    size_t popLevels(LevelMeter::Reading *out, size_t max) { return levels.popReadings(out, max); }
+    size_t popSpectra(LevelMeter::Spectrum *out, size_t max) { return levels.popSpectra(out, max); }
+    
     void setEnabled(bool enabled) { isEnabled.store(enabled); }
     bool getEnabled() const { return isEnabled.load(); }
 
+    // Samples dropped because the analysis thread fell behind the audio callback
+    uint64_t getOverrunCount() const { return audioRing.getOverrunCount(); }
+    // Wall time per hop of each analysis stage over the recent hops
+    LatencyStats::Summary getFrontEndLatency() const { return frontEndLatency.get(); }
+    LatencyStats::Summary getInferenceLatency() const { return inferenceLatency.get(); }
+    LatencyStats::Summary getDecoderLatency() const { return decoderLatency.get(); }
+
+    // Extra delay the tracker may add to batch frames into one model call.
+    // 0 runs every hop on its own; each hopLength of budget adds a frame.
+    void setLatencyBudgetMs(float ms) { latencyBudgetMs.store(std::max(0.0f, ms)); }
+    float getLatencyBudgetMs() const { return latencyBudgetMs.load(); }
+    int getBatchFrames() const { return batchFrames.load(); }
+    // Age of the newest analysed audio when its activations became available
+    float getPipelineLatencyMs() const { return pipelineLatencyMs.load(); }
+
 private:
     void processingThreadFunc();
-    void computeSpectrogram(const std::vector<float>& audioFrame, std::vector<float>& outSpectrogram);
-    void updateParticleFilter(float beatProb, float downbeatProb);
+    void loadModel();
+    // Analyses one hop if enough audio is buffered; false if not
+    bool processHop();
+    void skipInput();
+    // Fills out[0, 2 * numBands) with [log bands, positive diff]. Allocation-free.
+    void computeSpectrogram(const float *audioFrame, float *out);
+    // frameTimeNs: capture time of the centre of the analysed frame
+    void updateParticleFilter(float beatProb, float downbeatProb, int64_t frameTimeNs);
+    void setupBindings(int frames);
+    void runInference(int frames);
 
     // Threading and Buffering
     std::thread processingThread;
     std::atomic<bool> isRunning;
     std::atomic<bool> isEnabled;
     
-    std::mutex audioMutex;
-    std::deque<float> audioBuffer;
+    // Mono 22050 Hz samples from the audio callback to the analysis thread
+    SpscRing<float> audioRing;
+    // Audio thread only
+    void configureInput(int rate);
+    PolyphaseResampler resampler;
+    std::vector<float> monoScratch;
+    std::vector<float> resampledScratch;
+    bool wasEnabled = false;
+    std::atomic<int> inputRate{0};
+    std::atomic<float> inputGain{1.0f};
+    LevelMeter levels;
+    uint64_t hopCount = 0; // analysis thread
+
+    // Capture time of each callback's last sample, so frame times follow the
+    // real device buffer size instead of an assumed delay
+    struct AudioStamp {
+        uint64_t endSample; // samples written to audioRing, including this block
+        int64_t ns;
+    };
+    SpscRing<AudioStamp> stampRing;
+    uint64_t samplesWritten = 0; // audio thread only
+
+    // Analysis thread state
+    std::vector<float> analysisFrame;
+    uint64_t samplesRead = 0;
+    AudioStamp stamp = {0, 0};
+    int pending = 0;
+    int boundFrames = 0;
+    bool wasDisabled = false;
     
     // ONNX Runtime
     Ort::Env* ortEnv = nullptr;
     Ort::Session* ortSession = nullptr;
     Ort::AllocatorWithDefaultOptions allocator;
+    Ort::RunOptions runOptions;
+    // Tensors are bound once over the buffers below. The LSTM state ping-pongs:
+    // binding p reads lstmState[p] and writes lstmState[1 - p], so no copies.
+    std::unique_ptr<Ort::IoBinding> bindings[2];
+    std::vector<Ort::Value> boundValues;
+    std::vector<float> lstmState[2][2]; // [buffer][hidden, cell]
+    std::vector<float> modelOut;        // (1, 3, frames): beat, downbeat, non-beat rows
+    int stateParity = 0;
+    LatencyStats frontEndLatency;
+    LatencyStats inferenceLatency;
+    LatencyStats decoderLatency;
+
+    // Batching: frames are gathered in batchFeatures until batchFrames are ready
+    static const int maxBatchFrames = 16;
+    std::atomic<float> latencyBudgetMs{0.0f};
+    std::atomic<int> batchFrames{1};
+    std::atomic<float> pipelineLatencyMs{0.0f};
+    int featureSize = 272;
+    std::vector<float> batchFeatures;  // [maxBatchFrames][featureSize]
+    std::vector<int64_t> frameTimes;   // [maxBatchFrames]
     
     // DSP Parameters
     int sampleRate = 22050;
     int hopLength = 441;
-    int winLength = 2048; // zero padded
-    kiss_fftr_cfg fftCfg;
+    // 64ms frames, transformed unpadded as in BeatNet's madmom front-end
+    int winLength = 1411;
+    kiss_fft_cfg fftCfg = nullptr;
     std::vector<float> windowFunc;
     
-    // Mel filterbank
+    // 24 bands/octave log filterbank, 30Hz - 17kHz (136 bands at 22050Hz)
     int numBands = 136;
-    std::vector<std::vector<float>> filterbank; // [band][fft_bin]
+    SparseFilterbank filterbank;
     std::vector<float> prevSpectrogram;
+
+    // Per-hop scratch, sized once in setup()
+    std::vector<kiss_fft_cpx> fftIn;
+    std::vector<kiss_fft_cpx> fftOut;
+    std::vector<float> magnitudes;
+    std::vector<float> bandEnergy;
     
     // State
     std::atomic<float> currentBpm;
-    std::atomic<float> lastBeatTime;
+    std::atomic<int64_t> lastBeatTimeNs;
     float latencyOffsetMs = 0.0f;
+    SpscRing<Beat> beatEvents;
+    uint64_t beatIndex = 0;
+    std::atomic<bool> lastBeatDownbeat{false};
+    std::atomic<int> meter{4};
+    std::atomic<float> confidence{0.0f};
+    BeatParticleFilter particleFilter; // analysis thread only
     
     // Raw output history for debug
     std::vector<float> historyProb;
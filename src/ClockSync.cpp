@@ -0,0 +1,99 @@
+#include "ClockSync.h"
+#include "Network.h"
+#include "IPUtils.h"
+
+ClockSync::~ClockSync()
+{
+    stopThread();
+    waitForThread(true);
+}
+
+void ClockSync::setup(ClusterClock *_clock, Network *_net)
+{
+    clock = _clock;
+    net = _net;
+    setupSocket();
+    startThread();
+}
+
+void ClockSync::setupSocket()
+{
+    string broadcastIP = IPUtils::getBroadcastAddress();
+    if (broadcastIP == "0.0.0.0" || broadcastIP == "") broadcastIP = "192.168.1.255";
+
+    listener.Close();
+    listener.Create();
+    listener.SetReuseAddress(true);
+    listener.Bind(PORT);
+    listener.SetNonBlocking(true);
+
+    sender.Close();
+    sender.Create();
+    sender.SetReuseAddress(true);
+    sender.SetEnableBroadcast(true);
+    sender.Connect(broadcastIP.c_str(), PORT);
+    sender.SetNonBlocking(true);
+}
+
+void ClockSync::handlePacket(int size, int64_t rxNs)
+{
+    PacketHeader *h = (PacketHeader *)buffer;
+    if (size < (int)sizeof(PacketHeader) || h->id != PACKET_ID) return;
+    string myId = net->myId;
+    if (strncmp(h->senderId, myId.c_str(), 8) == 0) return;
+
+    if (h->type == PKT_TIME_REQUEST && net->isAuthority() && size >= (int)sizeof(TimeRequestPacket))
+    {
+        TimeRequestPacket *req = (TimeRequestPacket *)buffer;
+        TimeResponsePacket p;
+        p.header.type = PKT_TIME_RESPONSE;
+        memset(p.header.senderId, 0, 9);
+        strncpy(p.header.senderId, myId.c_str(), 8);
+        memcpy(p.requesterId, h->senderId, 8);
+        p.requesterId[8] = 0;
+        p.t0 = req->t0;
+        p.t1 = clock->toCluster(rxNs);
+        // Stamped last so our own processing time drops out of the peer's RTT
+        p.t2 = clock->nowNs();
+        sender.Send((const char *)&p, sizeof(p));
+    }
+    else if (h->type == PKT_TIME_RESPONSE && !net->isAuthority() && size >= (int)sizeof(TimeResponsePacket))
+    {
+        TimeResponsePacket *p = (TimeResponsePacket *)buffer;
+        if (strncmp(p->requesterId, myId.c_str(), 8) == 0)
+            clock->addSample(p->t0, p->t1, p->t2, rxNs);
+    }
+}
+
+void ClockSync::threadedFunction()
+{
+    while (isThreadRunning())
+    {
+        if (net->isAuthority())
+        {
+            clock->setMaster();
+        }
+        else
+        {
+            clock->setPeer();
+            int64_t now = ClusterClock::localNowNs();
+            if (clock->shouldRequest(now))
+            {
+                TimeRequestPacket p;
+                p.header.type = PKT_TIME_REQUEST;
+                memset(p.header.senderId, 0, 9);
+                strncpy(p.header.senderId, net->myId.c_str(), 8);
+                p.t0 = ClusterClock::localNowNs();
+                sender.Send((const char *)&p, sizeof(p));
+                clock->markRequested(now);
+            }
+        }
+
+        int size;
+        while ((size = listener.Receive(buffer, sizeof(buffer))) > 0)
+            handlePacket(size, ClusterClock::localNowNs());
+
+        // Short poll keeps arrival timestamps within a fraction of a millisecond
+        std::this_thread::sleep_for(std::chrono::microseconds(250));
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxNetwork.h"
+#include "ClusterClock.h"
+#include "PacketDef.h"
+
+class Network;
+
+// Runs the clock-sync exchange on its own socket and thread so packets are
+// timestamped as they arrive, not when the frame loop gets around to reading
+// them. The authority answers requests; peers feed replies into the clock.
+class ClockSync : public ofThread
+{
+public:
+    static const int PORT = 9001;
+
+    ~ClockSync();
+    void setup(ClusterClock *clock, Network *net);
+
+private:
+    ClusterClock *clock = nullptr;
+    Network *net = nullptr;
+    ofxUDPManager sender;
+    ofxUDPManager listener;
+    char buffer[256];
+
+    void setupSocket();
+    void handlePacket(int size, int64_t rxNs);
+    void threadedFunction() override;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <algorithm>
+#include "Timebase.h"
+
+// Shared timebase for the cluster. The authority's clock is the reference;
+// peers estimate their offset to it NTP-style from request/response pairs:
+//
+//   t0 peer sends, t1 authority receives, t2 authority replies, t3 peer receives
+//   offset = ((t1 - t0) + (t2 - t3)) / 2     rtt = (t3 - t0) - (t2 - t1)
+//
+// Scheduling and queueing add delay to one leg or the other; the sample with
+// the lowest RTT in a sliding window is the one least affected, and only that
+// one steers the offset. Samples are added from ClockSync's thread; the
+// offset is read lock-free from anywhere.
+class ClusterClock {
+public:
+    size_t window = 16;
+    int64_t stepThresholdNs = 10000000; // jump instead of slewing beyond 10ms
+    double slewAlpha = 0.2;
+    int64_t fastIntervalNs = 250000000; // request rate until the window is full
+    int64_t slowIntervalNs = 2000000000;
+
+    static int64_t localNowNs() { return Timebase::nowNs(); }
+
+    int64_t nowNs() const { return toCluster(localNowNs()); }
+    int64_t toCluster(int64_t localNs) const { return localNs + offsetNs.load(std::memory_order_relaxed); }
+    int64_t toLocal(int64_t clusterNs) const { return clusterNs - offsetNs.load(std::memory_order_relaxed); }
+
+    // Called on the authority: its own clock defines cluster time from now on.
+    // The current offset is kept so a peer promoted to master doesn't jump.
+    void setMaster() {
+        if (master) return;
+        master = true;
+        synced = true;
+        samples.clear();
+    }
+
+    void setPeer() {
+        if (!master) return;
+        master = false;
+        nextRequestNs = 0;
+    }
+
+    bool isMaster() const { return master; }
+    bool isSynced() const { return synced; }
+    int64_t getOffsetNs() const { return offsetNs.load(std::memory_order_relaxed); }
+    int64_t getRttNs() const { return bestRttNs.load(std::memory_order_relaxed); }
+
+    bool shouldRequest(int64_t localNow) const { return !master && localNow >= nextRequestNs; }
+
+    void markRequested(int64_t localNow) {
+        int64_t interval = samples.size() < window ? fastIntervalNs : slowIntervalNs;
+        // Jitter so peers don't all ask at the same moment
+        interval += (int64_t)(std::rand() % 16) * 1000000;
+        nextRequestNs = localNow + interval;
+    }
+
+    void addSample(int64_t t0, int64_t t1, int64_t t2, int64_t t3) {
+        if (master) return;
+        int64_t rtt = (t3 - t0) - (t2 - t1);
+        if (rtt < 0) return;
+        int64_t offset = ((t1 - t0) + (t2 - t3)) / 2;
+        samples.push_back({offset, rtt});
+        while (samples.size() > window) samples.pop_front();
+
+        auto best = std::min_element(samples.begin(), samples.end(),
+                                     [](const Sample &a, const Sample &b) { return a.rtt < b.rtt; });
+        bestRttNs.store(best->rtt, std::memory_order_relaxed);
+        int64_t current = offsetNs.load(std::memory_order_relaxed);
+        int64_t diff = best->offset - current;
+        if (!synced || std::llabs(diff) > stepThresholdNs)
+            offsetNs.store(best->offset, std::memory_order_relaxed);
+        else
+            offsetNs.store(current + (int64_t)(diff * slewAlpha), std::memory_order_relaxed);
+        synced = true;
+    }
+
+private:
+    struct Sample {
+        int64_t offset;
+        int64_t rtt;
+    };
+
+    std::deque<Sample> samples;
+    std::atomic<int64_t> offsetNs{0};
+    std::atomic<int64_t> bestRttNs{0};
+    int64_t nextRequestNs = 0;
+    std::atomic<bool> master{false};
+    std::atomic<bool> synced{false};
+};
@@ -1,5 +1,5 @@
 #include "Content.h"
-#include <unordered_set>
+#include <algorithm>
 
 TestTexture &TestTexture::getInstance()
 {
@@ -35,48 +35,86 @@ ofTexture &Content::getTexture()
 
 VideoContent::~VideoContent()
 {
-    if (loaderThread.joinable())
-        loaderThread.join();
+    unload();
+}
+
+void VideoContent::releaseLayer()
+{
+    if (auto video = lifecycle.get()) video->clearExternalTarget();
+    if (layer.isValid()) TextureArrayPool::getInstance().release(layer);
+    layer = TextureLayer();
 }
 
 void VideoContent::setup(string filename)
 {
     filePath = filename;
-    state = DORMANT;
 }
 
 void VideoContent::loadAsync()
 {
-    if (state != DORMANT) return;
-    state = LOADING;
-    
-    if (loaderThread.joinable()) loaderThread.join();
-    
-    loaderThread = std::thread([this]() {
-        auto newPlayer = std::make_shared<ofxMPVPlayer>();
+    uint64_t ticket = lifecycle.beginLoad();
+    if (!ticket) return;
+
+    loadJob = DecoderPool::getInstance().requestLoad([this, ticket](std::shared_ptr<ofxMPVPlayer> newPlayer) {
         newPlayer->metro = this->metro;
-        if (newPlayer->load(filePath)) {
-            newPlayer->setLoopState(OF_LOOP_NORMAL);
-            this->video = newPlayer;
-            this->state = READY;
-        } else {
-            this->state = ERROR;
-        }
+        // Small clips share a texture array layer instead of allocating their own FBO
+        ofxMPVPlayer *player = newPlayer.get();
+        newPlayer->onVideoReconfig = [this, player](int w, int h) {
+            knownWidth = w;
+            knownHeight = h;
+            if (layer.isValid() && (layer.width != w || layer.height != h)) releaseLayer();
+            if (!layer.isValid()) layer = TextureArrayPool::getInstance().acquire(w, h);
+            if (layer.isValid()) player->setExternalTarget(layer.fbo, layer.width, layer.height);
+        };
+        bool ok = newPlayer->load(filePath);
+        if (ok) newPlayer->setLoopState(OF_LOOP_NORMAL);
+        else lifecycle.failLoad(ticket);
+        // Failed, or evicted while we were loading: the GL thread gives the handle back
+        if (!ok || !lifecycle.finishLoad(ticket, newPlayer))
+            DecoderPool::getInstance().releaseDeferred(newPlayer);
     });
 }
 
+void VideoContent::unload()
+{
+    auto video = lifecycle.evict();
+    // Waits for a running load callback so it can't touch us after this returns
+    if (loadJob) DecoderPool::getInstance().cancel(loadJob);
+    loadJob = 0;
+    if (video) video->clearExternalTarget();
+    if (layer.isValid()) TextureArrayPool::getInstance().release(layer);
+    layer = TextureLayer();
+    if (video) DecoderPool::getInstance().release(video);
+    lifecycle.finishEvict();
+}
+
+void VideoContent::preload()
+{
+    bWantsToPlay = false;
+    loadAsync();
+}
+
+size_t VideoContent::getEstimatedBytes()
+{
+    // Assume 1080p until mpv reports the real size
+    size_t w = knownWidth > 0 ? knownWidth : 1920;
+    size_t h = knownHeight > 0 ? knownHeight : 1080;
+    // RGB target (double-buffered unless it is an array layer) plus a handful of NV12 decode surfaces
+    size_t targets = layer.isValid() ? 1 : 2;
+    return w * h * 3 * targets + w * h * 3 / 2 * 4;
+}
+
 void VideoContent::start()
 {
     bWantsToPlay = true;
-    if (state == DORMANT) {
-        loadAsync();
-    }
+    loadAsync();
 }
 
 void VideoContent::stop()
 {
     bWantsToPlay = false;
-    if (video && state == READY) {
+    auto video = lifecycle.get();
+    if (video) {
         video->setPaused(true);
         video->setPosition(0);
     }
@@ -84,32 +122,42 @@ void VideoContent::stop()
 
 void VideoContent::update()
 {
-    lastRequestFrame = ofGetFrameNum();
-    
-    if (state == READY && video) {
+    auto video = lifecycle.get();
+    if (video) {
         if (bWantsToPlay) {
             if (video->isPaused()) video->setPaused(false);
             else if (!video->isPlaying()) video->play();
+        } else if (video->isFrameNew() && !video->isPaused()) {
+            // Preloaded: hold on the first decoded frame until someone draws us
+            video->setPaused(true);
         }
         video->update();
     }
-    
-    // Auto-eviction if not used for 5 seconds
-    if (state == READY && (ofGetFrameNum() - lastRequestFrame > 300)) {
-        video.reset();
-        state = DORMANT;
-    }
 }
 
 ofTexture &VideoContent::getTexture()
 {
-    lastRequestFrame = ofGetFrameNum();
-    if (state == READY && video && video->getWidth() > 0)
+    auto video = lifecycle.get();
+    if (video && video->getWidth() > 0 && !video->hasExternalTarget())
         return video->getTexture();
     else
         return TestTexture::getInstance().getTexture();
 }
 
+bool VideoContent::getLayer(TextureLayer &out)
+{
+    auto video = lifecycle.get();
+    if (!video || !video->hasExternalTarget() || !layer.isValid()) return false;
+    out = layer;
+    return true;
+}
+
+const VideoPLL *VideoContent::getSyncPLL()
+{
+    auto video = lifecycle.get();
+    return video ? &video->getPLL() : nullptr;
+}
+
 void ContentManager::setup()
 {
     auto dtr = std::make_shared<Content>();
@@ -160,11 +208,37 @@ void ContentManager::refreshMedia(string mediaPath)
     {
         if (it->first == DEFAULT_CONTENT) { ++it; continue; }
         if (diskFiles.find(it->first) == diskFiles.end()) {
+            cache.erase(it->first);
             it = contents.erase(it);
         } else {
             ++it;
         }
     }
+    TextureArrayPool::getInstance().trim();
+}
+
+void ContentManager::touch(const std::string &id, Content &c)
+{
+    float now = ofGetElapsedTimef();
+    CacheEntry &e = cache[id];
+    if (!isActive(id, now) && id != DEFAULT_CONTENT)
+    {
+        if (c.isResident()) stats.hits++;
+        else stats.misses++;
+    }
+    e.lastUsed = now;
+}
+
+bool ContentManager::isActive(const std::string &id, float now)
+{
+    auto it = cache.find(id);
+    return it != cache.end() && it->second.lastUsed >= 0 && now - it->second.lastUsed < idleSeconds;
+}
+
+const VideoPLL *ContentManager::getSyncPLL(const std::string &id)
+{
+    auto it = contents.find(id);
+    return it == contents.end() ? nullptr : it->second->getSyncPLL();
 }
 
 ofTexture &ContentManager::getTextureById(std::string id)
@@ -172,26 +246,103 @@ ofTexture &ContentManager::getTextureById(std::string id)
     if (!contents.count(id))
         id = DEFAULT_CONTENT;
 
-    lastUsedFrame[id] = ofGetFrameNum();
+    touch(id, *contents[id]);
     return contents[id]->getTexture();
 }
 
+bool ContentManager::getLayerById(std::string id, TextureLayer &out)
+{
+    auto it = contents.find(id);
+    if (it == contents.end()) return false;
+    if (!it->second->getLayer(out)) return false;
+    touch(id, *it->second);
+    return true;
+}
+
 void ContentManager::update()
 {
-    uint64_t currentFrame = ofGetFrameNum();
+    float now = ofGetElapsedTimef();
+
+    std::unordered_set<std::string> warm;
+    size_t budget = (size_t)std::max(0, preloadBudgetMB) * 1024 * 1024;
+    size_t used = 0;
+    for (auto &id : preloadIds)
+    {
+        auto it = contents.find(id);
+        if (it == contents.end() || id == DEFAULT_CONTENT) continue;
+        if (isActive(id, now)) continue; // already on screen
+        size_t cost = it->second->getEstimatedBytes();
+        if (used + cost > budget) break;
+        used += cost;
+        warm.insert(id);
+    }
+
     for (auto &kv : contents)
     {
-        string id = kv.first;
+        const string &id = kv.first;
         if (id == DEFAULT_CONTENT) {
             kv.second->update();
             continue;
         }
 
-        if (currentFrame - lastUsedFrame[id] < 120) {
+        CacheEntry &e = cache[id];
+        if (isActive(id, now)) {
             kv.second->start();
             kv.second->update();
-        } else {
+            e.active = true;
+        } else if (warm.count(id)) {
+            kv.second->preload();
+            kv.second->update();
+            e.active = false;
+        } else if (e.active) {
             kv.second->stop();
+            e.active = false;
         }
     }
+
+    evict(now, warm);
+    DecoderPool::getInstance().update();
+}
+
+void ContentManager::unloadAll()
+{
+    for (auto &kv : contents) kv.second->unload();
+    cache.clear();
+}
+
+void ContentManager::evict(float now, const std::unordered_set<std::string> &warm)
+{
+    stats.budgetBytes = (size_t)std::max(0, cacheBudgetMB) * 1024 * 1024;
+    stats.residentBytes = 0;
+    stats.resident = 0;
+    stats.pinned = 0;
+    stats.preloaded = (int)warm.size();
+
+    vector<pair<float, string>> candidates;
+    for (auto &kv : contents)
+    {
+        if (!kv.second->isResident()) continue;
+        stats.resident++;
+        stats.residentBytes += kv.second->getEstimatedBytes();
+        const string &id = kv.first;
+        if (pinnedIds.count(id)) { stats.pinned++; continue; }
+        if (isActive(id, now) || warm.count(id)) continue;
+        candidates.push_back({cache[id].lastUsed, id});
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // Idle too long, over budget, or someone is waiting for a decoder: drop the least recently drawn
+    bool needDecoder = DecoderPool::getInstance().isSaturated();
+    for (auto &c : candidates)
+    {
+        bool idle = c.first < 0 || now - c.first > evictAfterSeconds;
+        if (!idle && stats.residentBytes <= stats.budgetBytes && !needDecoder) break;
+        Content &content = *contents[c.second];
+        size_t bytes = content.getEstimatedBytes();
+        content.unload();
+        stats.residentBytes -= std::min(bytes, stats.residentBytes);
+        stats.resident--;
+        stats.evictions++;
+        needDecoder = false;
+    }
 }
@@ -2,10 +2,13 @@
 #include "ofMain.h"
 #include "ofxMPVPlayer.h"
 #include "Metronome.h"
+#include "TextureArrayPool.h"
+#include "DecoderPool.h"
+#include "ContentLifecycle.h"
 #include <map>
+#include <unordered_set>
 #include <memory>
 #include <vector>
-#include <thread>
 #include <atomic>
 
 #define DEFAULT_CONTENT "default"
@@ -31,56 +34,110 @@ public:
     virtual void start() {}
     virtual void stop() {}
     virtual void update() {}
+    // Drops heavyweight resources (decoders, textures); start() brings them back
+    virtual void unload() {}
+    // Gets ready to start() instantly without showing anything yet
+    virtual void preload() {}
+    // Rough GPU + decoder memory held while loaded
+    virtual size_t getEstimatedBytes() { return 0; }
+    // True while holding a decoder or textures that unload() would free
+    virtual bool isResident() { return false; }
     virtual ofTexture &getTexture();
+    // True if the content currently renders into a shared texture array layer
+    virtual bool getLayer(TextureLayer &out) { return false; }
     virtual void setMetronome(Metronome* m) {}
+    // Beat-sync loop of a loaded, metronome-locked clip, for instrumentation
+    virtual const VideoPLL *getSyncPLL() { return nullptr; }
 };
 
 class VideoContent : public Content
 {
 private:
-    enum State {
-        DORMANT,
-        LOADING,
-        READY,
-        ERROR
-    };
-
-    std::shared_ptr<ofxMPVPlayer> video;
+    ContentLifecycle<ofxMPVPlayer> lifecycle;
     string filePath;
     Metronome* metro = nullptr;
-    std::atomic<State> state{DORMANT};
-    std::thread loaderThread;
-    
-    uint64_t lastRequestFrame = 0;
+    uint64_t loadJob = 0;
+
     bool bWantsToPlay = false;
+    TextureLayer layer;
+    int knownWidth = 0;
+    int knownHeight = 0;
 
     void loadAsync();
+    void releaseLayer();
 
 public:
     VideoContent() = default;
     ~VideoContent();
 
     void setup(string filename) override;
-    void setMetronome(Metronome* m) override { metro = m; if(video) video->metro = m; }
+    void setMetronome(Metronome* m) override { metro = m; if (auto video = lifecycle.get()) video->metro = m; }
     void start() override;
     void stop() override;
     void update() override;
+    void unload() override;
+    void preload() override;
+    size_t getEstimatedBytes() override;
+    bool isResident() override { return lifecycle.getState() != ContentLifecycle<ofxMPVPlayer>::DORMANT; }
     ofTexture &getTexture() override;
+    bool getLayer(TextureLayer &out) override;
+    const VideoPLL *getSyncPLL() override;
+};
+
+struct ContentCacheStats {
+    size_t residentBytes = 0;
+    size_t budgetBytes = 0;
+    int resident = 0;
+    int pinned = 0;
+    int preloaded = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
 };
 
+// Keeps every registered content, but only as many of them loaded as fit in
+// cacheBudgetMB. Least recently drawn clips are unloaded first, and any clip
+// not drawn for evictAfterSeconds is unloaded regardless; clips drawn in the
+// last idleSeconds, pinned by the current state, or preloaded are kept.
 class ContentManager
 {
 private:
+    struct CacheEntry {
+        float lastUsed = -1; // ofGetElapsedTimef() of the last draw, -1 if never
+        bool active = false; // started and being drawn
+    };
+
     std::map<std::string, std::shared_ptr<Content>> contents;
-    std::map<std::string, uint64_t> lastUsedFrame;
+    std::map<std::string, CacheEntry> cache;
+    std::vector<std::string> preloadIds;
+    std::unordered_set<std::string> pinnedIds;
+    ContentCacheStats stats;
     Metronome* metro = nullptr;
 
+    void touch(const std::string &id, Content &c);
+    bool isActive(const std::string &id, float now);
+    void evict(float now, const std::unordered_set<std::string> &warm);
+
 public:
+    int preloadBudgetMB = 256;
+    int cacheBudgetMB = 1024;
+    float idleSeconds = 2.0f;
+    float evictAfterSeconds = 30.0f;
+
     void setup();
     void setMetronome(Metronome* m) { metro = m; }
     vector<string> getContentNames();
     bool registerContent(std::string id, std::shared_ptr<Content> c);
     void refreshMedia(string mediaPath);
     ofTexture &getTextureById(std::string id);
+    bool getLayerById(std::string id, TextureLayer &out);
+    // Ids to keep warm, most likely first; trimmed to preloadBudgetMB in update()
+    void setPreloadSet(const std::vector<std::string> &ids) { preloadIds = ids; }
+    // Ids that must never be evicted, e.g. everything the current state shows
+    void setPinned(const std::vector<std::string> &ids) { pinnedIds = std::unordered_set<std::string>(ids.begin(), ids.end()); }
+    const ContentCacheStats &getStats() const { return stats; }
+    const VideoPLL *getSyncPLL(const std::string &id);
     void update();
+    // Unloads every content and hands its decoder back. Call from the GL thread.
+    void unloadAll();
 };
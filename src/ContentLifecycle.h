@@ -0,0 +1,71 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+// Load/unload state machine for a content's player, shared between the GL
+// thread and the decoder worker:
+//
+//   DORMANT -beginLoad-> LOADING -finishLoad-> READY -evict-> EVICTING -finishEvict-> DORMANT
+//                                -failLoad--> FAILED -evict-> ...
+//
+// Transitions are serialized by a mutex; getState() and get() are lock-free so
+// the render path never waits on the loader. Every beginLoad() hands out a
+// ticket and evict() invalidates it, so a load that completes after the
+// content was evicted (or reloaded) is rejected instead of resurrecting a
+// stale player.
+template <typename Player>
+class ContentLifecycle {
+public:
+    enum State { DORMANT, LOADING, READY, EVICTING, FAILED };
+
+    State getState() const { return state.load(std::memory_order_acquire); }
+
+    std::shared_ptr<Player> get() const { return std::atomic_load(&player); }
+
+    // Returns a ticket for finishLoad/failLoad, or 0 if not DORMANT.
+    uint64_t beginLoad() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (getState() != DORMANT) return 0;
+        state.store(LOADING, std::memory_order_release);
+        return ++generation;
+    }
+
+    // Publishes the player. Returns false if the ticket is stale; the caller
+    // still owns p and has to dispose of it.
+    bool finishLoad(uint64_t ticket, std::shared_ptr<Player> p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ticket != generation || getState() != LOADING) return false;
+        std::atomic_store(&player, p);
+        state.store(READY, std::memory_order_release);
+        return true;
+    }
+
+    void failLoad(uint64_t ticket) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ticket != generation || getState() != LOADING) return;
+        state.store(FAILED, std::memory_order_release);
+    }
+
+    // Moves to EVICTING and takes the player out (may be null). Any load in
+    // flight is invalidated. Call finishEvict() once the player is disposed of.
+    std::shared_ptr<Player> evict() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (getState() == DORMANT) return nullptr;
+        generation++;
+        state.store(EVICTING, std::memory_order_release);
+        return std::atomic_exchange(&player, std::shared_ptr<Player>());
+    }
+
+    void finishEvict() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (getState() == EVICTING) state.store(DORMANT, std::memory_order_release);
+    }
+
+private:
+    std::mutex mutex;
+    std::atomic<State> state{DORMANT};
+    std::shared_ptr<Player> player;
+    uint64_t generation = 0;
+};
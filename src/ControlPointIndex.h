@@ -0,0 +1,156 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// Uniform grid over the normalized control-point space (0..1 on both axes).
+// Keeps a cached bounding box and a running centroid so hit testing, rect
+// queries and scale pivots only touch the points that actually changed.
+class ControlPointIndex {
+public:
+    template <typename P>
+    void rebuild(const std::vector<P> &pts) {
+        count = (int)pts.size();
+        side = std::max(1, (int)std::ceil(std::sqrt((float)count)));
+        cells.assign(side * side, std::vector<int>());
+        pointCell.assign(count, 0);
+        sumX = sumY = 0;
+        for (int i = 0; i < count; i++) {
+            int c = cellFor(pts[i].x, pts[i].y);
+            pointCell[i] = c;
+            cells[c].push_back(i);
+            sumX += pts[i].x;
+            sumY += pts[i].y;
+        }
+        recomputeBounds(pts);
+    }
+
+    // Moves a single point between cells; call after pts[idx] has been written,
+    // passing the position it had before the edit.
+    template <typename P>
+    void update(const std::vector<P> &pts, int idx, float oldX, float oldY) {
+        if (idx < 0 || idx >= count) return;
+        int c = cellFor(pts[idx].x, pts[idx].y);
+        if (c != pointCell[idx]) {
+            auto &oldCell = cells[pointCell[idx]];
+            auto it = std::find(oldCell.begin(), oldCell.end(), idx);
+            if (it != oldCell.end()) {
+                *it = oldCell.back();
+                oldCell.pop_back();
+            }
+            cells[c].push_back(idx);
+            pointCell[idx] = c;
+        }
+        sumX += (double)pts[idx].x - oldX;
+        sumY += (double)pts[idx].y - oldY;
+        // Growing the box is free; shrinking needs a rescan, so defer it until
+        // someone asks and only if the point used to sit on the boundary.
+        if (boundsDirty) return;
+        const P &p = pts[idx];
+        if (oldX == minX || oldX == maxX || oldY == minY || oldY == maxY) {
+            boundsDirty = true;
+            return;
+        }
+        minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+        minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+    }
+
+    // Closest point within maxDistPx of (x, y), measured in pixels of a w x h
+    // viewport. Returns -1 if nothing is in range.
+    template <typename P>
+    int nearest(const std::vector<P> &pts, float x, float y, float w, float h, float maxDistPx) {
+        if (count == 0 || w <= 0 || h <= 0) return -1;
+        int cx0, cy0, cx1, cy1;
+        cellRange((x - maxDistPx) / w, (y - maxDistPx) / h, (x + maxDistPx) / w, (y + maxDistPx) / h, cx0, cy0, cx1, cy1);
+        float best = maxDistPx * maxDistPx;
+        int hit = -1;
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                for (int i : cells[cx + cy * side]) {
+                    float dx = pts[i].x * w - x;
+                    float dy = pts[i].y * h - y;
+                    float d = dx * dx + dy * dy;
+                    if (d < best || (d == best && hit != -1 && i < hit)) { best = d; hit = i; }
+                }
+            }
+        }
+        return hit;
+    }
+
+    // Indices of all points inside the normalized rectangle, in ascending order.
+    template <typename P>
+    void queryRect(const std::vector<P> &pts, float x0, float y0, float x1, float y1, std::vector<int> &out) {
+        out.clear();
+        if (count == 0) return;
+        if (x0 > x1) std::swap(x0, x1);
+        if (y0 > y1) std::swap(y0, y1);
+        int cx0, cy0, cx1, cy1;
+        cellRange(x0, y0, x1, y1, cx0, cy0, cx1, cy1);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                for (int i : cells[cx + cy * side]) {
+                    const P &p = pts[i];
+                    if (p.x >= x0 && p.x <= x1 && p.y >= y0 && p.y <= y1) out.push_back(i);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    template <typename P>
+    bool contains(const std::vector<P> &pts, float nx, float ny) {
+        if (count == 0) return false;
+        if (boundsDirty) recomputeBounds(pts);
+        return nx >= minX && nx <= maxX && ny >= minY && ny <= maxY;
+    }
+
+    template <typename P>
+    void getBounds(const std::vector<P> &pts, float &x0, float &y0, float &x1, float &y1) {
+        if (boundsDirty) recomputeBounds(pts);
+        x0 = minX; y0 = minY; x1 = maxX; y1 = maxY;
+    }
+
+    void getCentroid(float &cx, float &cy) const {
+        cx = count ? (float)(sumX / count) : 0.0f;
+        cy = count ? (float)(sumY / count) : 0.0f;
+    }
+
+    int size() const { return count; }
+
+private:
+    int count = 0;
+    int side = 1;
+    std::vector<std::vector<int>> cells;
+    std::vector<int> pointCell;
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    bool boundsDirty = false;
+    double sumX = 0, sumY = 0;
+
+    int clampCell(float v) const {
+        float c = std::floor(v * side);
+        if (!(c > 0)) return 0;
+        return c >= side - 1 ? side - 1 : (int)c;
+    }
+
+    int cellFor(float x, float y) const { return clampCell(x) + clampCell(y) * side; }
+
+    void cellRange(float x0, float y0, float x1, float y1, int &cx0, int &cy0, int &cx1, int &cy1) const {
+        cx0 = clampCell(x0); cy0 = clampCell(y0);
+        cx1 = clampCell(x1); cy1 = clampCell(y1);
+    }
+
+    template <typename P>
+    void recomputeBounds(const std::vector<P> &pts) {
+        boundsDirty = false;
+        if (pts.empty()) { minX = minY = maxX = maxY = 0; return; }
+        minX = maxX = pts[0].x;
+        minY = maxY = pts[0].y;
+        for (const auto &p : pts) {
+            if (p.x < minX) minX = p.x;
+            if (p.x > maxX) maxX = p.x;
+            if (p.y < minY) minY = p.y;
+            if (p.y > maxY) maxY = p.y;
+        }
+    }
+};
@@ -4,6 +4,7 @@
 
 void Core::setup(bool headless) {
     bHeadless = headless;
+    metro.clock = &clock;
     metro.setup();
     tracker.setup();
 
@@ -12,17 +13,81 @@ void Core::setup(bool headless) {
     }
     
     reloadProject(pPath);
+    // After the project so the device and gain come from its config. Headless
+    // nodes have never listened to an input, so they don't open one.
+    if (!bHeadless) setupAudio();
+}
+
+void Core::setupAudio() {
+    soundStream.close();
+    inputDevices.clear();
+    for (auto &device : soundStream.getDeviceList())
+        if (device.inputChannels > 0) inputDevices.push_back(device);
+
+    ofSoundStreamSettings settings;
+    settings.numOutputChannels = 0;
+    settings.numInputChannels = 1;
+    settings.sampleRate = 44100;
+    settings.bufferSize = 512;
+    settings.numBuffers = 4;
+
+    const ofSoundDevice *chosen = nullptr;
+    for (auto &device : inputDevices) {
+        if (!identity.audioDevice.empty() && device.name == identity.audioDevice) chosen = &device;
+        if (!chosen && identity.audioDevice.empty() && device.isDefaultInput) chosen = &device;
+    }
+    if (!chosen && !identity.audioDevice.empty()) {
+        ofLogWarning("Core") << "Audio device \"" << identity.audioDevice << "\" not found, using the default input";
+        for (auto &device : inputDevices)
+            if (device.isDefaultInput) chosen = &device;
+    }
+    if (chosen) {
+        settings.setInDevice(*chosen);
+        // Up to two channels, downmixed by the tracker
+        settings.numInputChannels = std::min(2u, chosen->inputChannels);
+        // 44.1 kHz halves exactly, 48 kHz is the other common native rate;
+        // failing both, the device's highest
+        auto &rates = chosen->sampleRates;
+        auto offers = [&](unsigned int r) { return std::find(rates.begin(), rates.end(), r) != rates.end(); };
+        if (!rates.empty() && !offers(44100)) settings.sampleRate = offers(48000) ? 48000 : *std::max_element(rates.begin(), rates.end());
+    }
+
+    settings.setInListener(this);
+    tracker.setInputRate(settings.sampleRate);
+    if (!soundStream.setup(settings)) {
+        ofLogError("Core") << "Could not open audio input at " << settings.sampleRate << " Hz";
+        return;
+    }
+    ofLogNotice("Core") << "Audio input: " << (chosen ? chosen->name : string("default")) << ", " << settings.numInputChannels
+                        << " ch at " << settings.sampleRate << " Hz";
+}
+
+void Core::audioIn(ofSoundBuffer &input) {
+    tracker.audioIn(input);
 }
 
 void Core::update() {
+    // Fire scheduled recalls first so their content starts loading this frame
+    scheduler.lookaheadNs = identity.scheduleLookaheadMs * Timebase::NS_PER_MS;
+    scheduler.update(metro.nowNs());
+    tracker.setLatencyBudgetMs((float)identity.trackerLatencyBudgetMs);
+    tracker.setInputGain(identity.audioGain);
     tracker.update();
     watcher.update();
+    warper.contents.preloadBudgetMB = identity.preloadBudgetMB;
+    warper.contents.cacheBudgetMB = identity.cacheBudgetMB;
+    warper.contents.setPreloadSet(stateMgr.getLikelyContent(identity.myId));
+    vector<string> shown;
+    for (auto &s : warper.getSurfacesForPeer(identity.myId)) shown.push_back(s->getContentId());
+    warper.contents.setPinned(shown);
     warper.update();
     net.updatePeers();
 
+    followTracker();
+
     if (net.isAuthority()) {
         if (ofGetFrameNum() % 60 == 0) {
-            net.sendMetronome(metro.bpm, metro.referenceTime, metro.beatsPerBar);
+            net.sendMetronome(metro.bpm, metro.referenceTimeNs, metro.beatsPerBar);
         }
     }
 
@@ -34,6 +99,31 @@ void Core::update() {
     handlePackets();
 }
 
+// On the master, steers the metronome with the beats the tracker detected
+// since the last frame and broadcasts the result straight away; peers follow
+// through PKT_METRONOME as with tap tempo. Each beat also goes out as its own
+// PKT_BEAT and is raised locally as a beatEvent.
+void Core::followTracker() {
+    BeatTracker::Beat beats[16];
+    size_t n;
+    while ((n = tracker.popBeats(beats, 16)) > 0) {
+        if (!tracker.getEnabled() || !net.isAuthority()) {
+            tempoSync.reset();
+            continue;
+        }
+        bool changed = false;
+        for (size_t i = 0; i < n; i++) {
+            const BeatTracker::Beat &b = beats[i];
+            int64_t clusterNs = clock.toCluster(b.timeNs);
+            net.sendBeat((uint32_t)b.index, clusterNs, b.confidence, b.beatInBar, b.downbeat);
+            ClusterBeat ev = {(uint32_t)b.index, clusterNs, b.confidence, b.beatInBar, b.downbeat, false};
+            ofNotifyEvent(beatEvent, ev, this);
+            changed |= tempoSync.onBeat(metro, clusterNs, b.bpm, b.confidence, b.downbeat, b.meter);
+        }
+        if (changed) net.sendMetronome(metro.bpm, metro.referenceTimeNs, metro.beatsPerBar);
+    }
+}
+
 void Core::handlePackets() {
     int size = 0;
     while ((size = net.receive(packetBuffer, 65535)) > 0) {
@@ -57,14 +147,27 @@ void Core::handlePackets() {
         } else if (h->type == PKT_METRONOME && !net.isAuthority()) {
             MetronomePacket *p = (MetronomePacket *)packetBuffer;
             metro.bpm = p->bpm;
-            metro.referenceTime = p->referenceTime;
+            metro.referenceTimeNs = p->referenceTimeNs;
             metro.beatsPerBar = p->beatsPerBar;
+        } else if (h->type == PKT_BEAT && !net.isAuthority()) {
+            if (size < (int)sizeof(BeatPacket)) continue;
+            BeatPacket *p = (BeatPacket *)packetBuffer;
+            // Drop duplicates of the last beat from the same master
+            string sender(h->senderId, strnlen(h->senderId, 8));
+            if (sender == lastBeatSender && p->beatIndex == lastRemoteBeat) continue;
+            lastBeatSender = sender;
+            lastRemoteBeat = p->beatIndex;
+            ClusterBeat ev = {p->beatIndex, p->beatTimeNs, p->confidence, p->beatInBar, p->downbeat != 0, true};
+            ofNotifyEvent(beatEvent, ev, this);
         } else if (h->type == PKT_STRUCT && !net.isAuthority()) {
             string jStr(packetBuffer + sizeof(PacketHeader), size - sizeof(PacketHeader));
-            string warpPath = ofFilePath::join(ofFilePath::join(projectPath, "configs"), "warps.json");
-            ofLogNotice("Core") << "Saving PKT_STRUCT to " << warpPath << ". Content: " << jStr;
-            ofBufferToFile(warpPath, ofBuffer(jStr.c_str(), jStr.length()));
+            saveWarps(jStr);
             warper.loadJson(jStr);
+        } else if (h->type == PKT_STATE_SCHEDULE && !net.isAuthority()) {
+            if (size < (int)sizeof(StateSchedulePacket)) continue;
+            StateSchedulePacket *p = (StateSchedulePacket *)packetBuffer;
+            string jStr(packetBuffer + sizeof(StateSchedulePacket), size - sizeof(StateSchedulePacket));
+            stateMgr.scheduleStructure(p->targetTimeNs, jStr, warper, scheduler, -1, true);
         } else if (h->type == PKT_FILE_OFFER && !net.isAuthority()) {
             FileOfferPacket *p = (FileOfferPacket *)packetBuffer;
             string name = string(packetBuffer + sizeof(FileOfferPacket), p->nameLen);
@@ -100,6 +203,18 @@ void Core::handlePackets() {
             WarpScaleAllPacket *p = (WarpScaleAllPacket *)packetBuffer;
             auto subset = warper.getSurfacesForPeer(p->ownerId);
             if (p->surfaceIndex < subset.size()) subset[p->surfaceIndex]->scaleAll(p->scaleFactor, glm::vec2(p->centroidX, p->centroidY), p->mode);
+        } else if (h->type == PKT_WARP_SELECTION && !net.isAuthority()) {
+            if (size < (int)sizeof(WarpSelectionPacket)) continue;
+            WarpSelectionPacket *p = (WarpSelectionPacket *)packetBuffer;
+            if (size < (int)(sizeof(WarpSelectionPacket) + p->count * sizeof(uint16_t))) continue;
+            vector<int> indices(p->count);
+            for (size_t i = 0; i < indices.size(); i++) {
+                uint16_t idx;
+                memcpy(&idx, packetBuffer + sizeof(WarpSelectionPacket) + i * sizeof(uint16_t), sizeof(uint16_t));
+                indices[i] = idx;
+            }
+            auto subset = warper.getSurfacesForPeer(p->ownerId);
+            if (p->surfaceIndex < subset.size()) subset[p->surfaceIndex]->transformPoints(indices, p->op, p->a, p->b, glm::vec2(p->pivotX, p->pivotY), p->mode);
         } else if (h->type == PKT_FULLSCREEN) {
             FullscreenPacket *p = (FullscreenPacket *)packetBuffer;
             if (strncmp(p->targetId, identity.myId.c_str(), 8) == 0 || strncmp(p->targetId, "ALL", 3) == 0) {
@@ -111,8 +226,17 @@ void Core::handlePackets() {
     }
 }
 
+void Core::saveWarps(const string &jStr) {
+    string warpPath = ofFilePath::join(ofFilePath::join(projectPath, "configs"), "warps.json");
+    ofLogNotice("Core") << "Saving structure to " << warpPath << ". Content: " << jStr;
+    ofBufferToFile(warpPath, ofBuffer(jStr.c_str(), jStr.length()));
+}
+
 void Core::reloadProject(string path) {
     projectPath = path;
+    // Pending recalls refer to the old project's surfaces
+    scheduler.clear();
+    stateMgr.clearPending();
     ofDirectory dir(path);
     if (!dir.exists()) dir.create(true);
 
@@ -125,6 +249,7 @@ void Core::reloadProject(string path) {
     identity.setup(ofFilePath::join(configsDir, "config.json"), bHeadless);
     if (!net.isThreadRunning()) net.setup(identity.myId, mediaDir);
     else net.setMediaPath(mediaDir);
+    if (!clockSync.isThreadRunning()) clockSync.setup(&clock, &net);
 
     warper.metro = &metro;
     warper.setup(ofFilePath::join(configsDir, "warps.json"), mediaDir, identity.myId);
@@ -181,5 +306,9 @@ string Core::loadSettings() {
 }
 
 void Core::exit() {
-    // Cleanup if needed
+    soundStream.close();
+    // Hand every decoder back, then stop the loader worker and free them all
+    // while the GL context still exists; ~VideoContent has nothing left to release
+    warper.contents.unloadAll();
+    DecoderPool::getInstance().shutdown();
 }
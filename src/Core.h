@@ -7,8 +7,23 @@
 #include "StateManager.h"
 #include "Metronome.h"
 #include "BeatTracker.h"
+#include "ClusterClock.h"
+#include "ClockSync.h"
+#include "BeatScheduler.h"
+#include "TempoSync.h"
 
-class Core {
+// A tracker beat in cluster time: the master's own on detection, a peer's
+// from PKT_BEAT
+struct ClusterBeat {
+    uint32_t index;
+    int64_t timeNs;      // Cluster time (ns)
+    float confidence;    // 0..1
+    int beatInBar;       // 0 = downbeat
+    bool downbeat;
+    bool remote;         // received from the master
+};
+
+class Core : public ofBaseSoundInput {
 public:
     void setup(bool headless);
     void update();
@@ -21,6 +36,13 @@ public:
     void saveSettings(string path);
     string loadSettings();
 
+    // (Re)opens the audio input named in identity.audioDevice at a rate it
+    // offers natively; the tracker resamples to what the model needs
+    void setupAudio();
+    void audioIn(ofSoundBuffer &input) override;
+    // Input-capable devices, as of the last setupAudio()
+    const vector<ofSoundDevice> &getInputDevices() const { return inputDevices; }
+
     // Core state and systems
     bool bHeadless = false;
     Identity identity;
@@ -28,12 +50,21 @@ public:
     WarpController warper;
     MediaWatcher watcher;
     StateManager stateMgr;
+    ClusterClock clock;
+    ClockSync clockSync;
     Metronome metro;
+    BeatScheduler scheduler;
     BeatTracker tracker;
+    TempoSync tempoSync;
+    ofSoundStream soundStream;
     
     string projectPath;
     string mediaDir;
 
+    // Fires on the main thread for every tracker beat, on the master and on
+    // peers alike, so beat-reactive content needn't extrapolate the metronome
+    ofEvent<ClusterBeat> beatEvent;
+
     struct {
         bool active = false;
         string name;
@@ -44,5 +75,10 @@ public:
 
 private:
     char packetBuffer[65535];
+    uint32_t lastRemoteBeat = 0;
+    string lastBeatSender;
+    vector<ofSoundDevice> inputDevices;
+    void followTracker();
     void handlePackets();
+    void saveWarps(const string &jStr);
 };
@@ -0,0 +1,175 @@
+#include "DecoderPool.h"
+
+DecoderPool &DecoderPool::getInstance()
+{
+    static DecoderPool instance;
+    return instance;
+}
+
+DecoderPool::~DecoderPool()
+{
+    shutdown();
+}
+
+void DecoderPool::ensureWorker()
+{
+    // Called with the mutex held
+    if (running) return;
+    running = true;
+    worker = std::thread(&DecoderPool::workerLoop, this);
+}
+
+uint64_t DecoderPool::requestLoad(LoadCallback cb)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ensureWorker();
+    uint64_t id = nextId++;
+    jobs.push_back({id, cb});
+    cv.notify_all();
+    return id;
+}
+
+void DecoderPool::cancel(uint64_t id)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (auto it = jobs.begin(); it != jobs.end(); ++it)
+    {
+        if (it->id == id)
+        {
+            jobs.erase(it);
+            return;
+        }
+    }
+    cv.wait(lock, [&] { return runningId != id; });
+}
+
+void DecoderPool::release(std::shared_ptr<ofxMPVPlayer> player)
+{
+    if (!player) return;
+    player->unload();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if ((int)idle.size() < maxIdle && running)
+    {
+        idle.push_back(player);
+    }
+    else
+    {
+        // Destroyed here, on the GL thread, so the render context is freed correctly
+        live--;
+        player.reset();
+    }
+    cv.notify_all();
+}
+
+void DecoderPool::releaseDeferred(std::shared_ptr<ofxMPVPlayer> player)
+{
+    if (!player) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    deferred.push_back(player);
+}
+
+void DecoderPool::update()
+{
+    std::vector<std::shared_ptr<ofxMPVPlayer>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(deferred);
+        for (auto &p : idle) p->prepareGL();
+    }
+    for (auto &p : pending) release(p);
+}
+
+void DecoderPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) return;
+        running = false;
+        jobs.clear();
+        cv.notify_all();
+    }
+    if (worker.joinable()) worker.join();
+
+    // Handles from loads that finished too late are unloaded here rather than
+    // whenever their last reference goes; release() no longer keeps them
+    std::vector<std::shared_ptr<ofxMPVPlayer>> pending;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.swap(deferred);
+    }
+    for (auto &p : pending) release(p);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    live -= (int)idle.size();
+    idle.clear();
+}
+
+int DecoderPool::getLiveCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return live;
+}
+
+int DecoderPool::getIdleCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)idle.size();
+}
+
+int DecoderPool::getQueueLength()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return (int)jobs.size();
+}
+
+bool DecoderPool::isSaturated()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return idle.empty() && live >= maxDecoders && !jobs.empty();
+}
+
+void DecoderPool::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Pre-create the warm set so the first clips don't pay for mpv_initialize
+    while (running && (int)idle.size() < maxIdle && live < maxDecoders)
+    {
+        live++;
+        lock.unlock();
+        auto p = std::make_shared<ofxMPVPlayer>();
+        lock.lock();
+        idle.push_back(p);
+    }
+
+    while (running)
+    {
+        cv.wait(lock, [&] { return !running || (!jobs.empty() && (!idle.empty() || live < maxDecoders)); });
+        if (!running) break;
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        runningId = job.id;
+
+        std::shared_ptr<ofxMPVPlayer> player;
+        if (!idle.empty())
+        {
+            player = idle.back();
+            idle.pop_back();
+            lock.unlock();
+        }
+        else
+        {
+            live++;
+            lock.unlock();
+            player = std::make_shared<ofxMPVPlayer>();
+        }
+
+        job.cb(player);
+
+        lock.lock();
+        runningId = 0;
+        cv.notify_all();
+    }
+}
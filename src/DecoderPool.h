@@ -0,0 +1,69 @@
+#pragma once
+#include "ofMain.h"
+#include "ofxMPVPlayer.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+// Bounded set of mpv handles shared by all VideoContents, plus the single
+// worker thread that creates them and services load requests. Released
+// players are stopped and kept warm (mpv core + GL render context) so the
+// next clip skips mpv_create/mpv_initialize.
+class DecoderPool
+{
+public:
+    using LoadCallback = std::function<void(std::shared_ptr<ofxMPVPlayer>)>;
+
+    DecoderPool(const DecoderPool &) = delete;
+    void operator=(const DecoderPool &) = delete;
+    static DecoderPool &getInstance();
+
+    int maxDecoders = 8; // live mpv handles, in use or idle
+    int maxIdle = 3;     // warm handles kept around when nothing needs them
+
+    // Queues a load. The callback runs on the worker thread with a reset player
+    // once one is free. Returns an id for cancel().
+    uint64_t requestLoad(LoadCallback cb);
+    // Drops a pending request, or blocks until it finishes if it is running.
+    void cancel(uint64_t id);
+    // Returns a player to the pool. Call from the GL thread.
+    void release(std::shared_ptr<ofxMPVPlayer> player);
+    // Same as release(), for any thread; the player is handed back on the next update().
+    void releaseDeferred(std::shared_ptr<ofxMPVPlayer> player);
+
+    // Call from the GL thread; brings idle handles' render contexts up.
+    void update();
+    void shutdown();
+
+    int getLiveCount();
+    int getIdleCount();
+    int getQueueLength();
+    bool isSaturated();
+
+private:
+    DecoderPool() {}
+    ~DecoderPool();
+
+    struct Job {
+        uint64_t id;
+        LoadCallback cb;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<Job> jobs;
+    std::vector<std::shared_ptr<ofxMPVPlayer>> idle;
+    std::vector<std::shared_ptr<ofxMPVPlayer>> deferred;
+    int live = 0;
+    uint64_t nextId = 1;
+    uint64_t runningId = 0;
+    bool running = false;
+    std::thread worker;
+
+    void ensureWorker();
+    void workerLoop();
+};
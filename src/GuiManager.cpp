@@ -121,6 +121,19 @@ void GuiManager::drawPerformUi(AppComponents &c)
                 ImGui::PopStyleColor();
 
                 ImGui::Text("Beat: %d", c.metro.getBeatInBar());
+                ImGui::SetNextItemWidth(120);
+                ImGui::SliderInt("Schedule Lookahead (ms)", &c.identity.scheduleLookaheadMs, 0, 1000);
+                if (ImGui::IsItemDeactivatedAfterEdit()) c.identity.save();
+                if (c.core.scheduler.getPendingCount() > 0) {
+                    double beats = c.metro.getBeatAt(c.core.scheduler.getNextTargetNs()) - c.metro.getBeat();
+                    ImGui::TextDisabled("Scheduled: %d, next in %.2f beats", (int)c.core.scheduler.getPendingCount(), beats);
+                }
+                if (c.core.clock.isMaster())
+                    ImGui::TextDisabled("Cluster clock: reference");
+                else if (c.core.clock.isSynced())
+                    ImGui::TextDisabled("Cluster clock: offset %.3f ms, rtt %.3f ms", c.core.clock.getOffsetNs() / 1e6, c.core.clock.getRttNs() / 1e6);
+                else
+                    ImGui::TextDisabled("Cluster clock: waiting for master");
 
                 ImGui::Separator();
                 ImGui::Text("Neural Beat Tracker");
@@ -133,7 +146,17 @@ void GuiManager::drawPerformUi(AppComponents &c)
                     if (ImGui::SliderFloat("Tracker Latency", &latency, -500.0f, 500.0f)) {
                         c.tracker.setLatencyOffset(latency);
                     }
-                    ImGui::Text("Detected BPM: %.1f", c.tracker.getBPM());
+                    ImGui::SetNextItemWidth(120);
+                    ImGui::SliderInt("Latency Budget (ms)", &c.identity.trackerLatencyBudgetMs, 0, 300);
+                    if (ImGui::IsItemDeactivatedAfterEdit()) c.identity.save();
+                    ImGui::Text("Detected BPM: %.1f, %d/4, confidence %.2f", c.tracker.getBPM(), c.tracker.getMeter(), c.tracker.getConfidence());
+                    LatencyStats::Summary lat = c.tracker.getInferenceLatency();
+                    ImGui::TextDisabled("Inference p50 %.0f us, p95 %.0f us, p99 %.0f us, max %.0f us (per frame)", lat.p50, lat.p95, lat.p99, lat.max);
+                    if (c.core.tempoSync.isLocked())
+                        ImGui::TextDisabled("Tempo sync: locked, phase error %+.3f beats", c.core.tempoSync.getPhaseError());
+                    else
+                        ImGui::TextDisabled("Tempo sync: waiting for a confident beat");
+                    ImGui::TextDisabled("Batch %d frames, pipeline latency %.1f ms", c.tracker.getBatchFrames(), c.tracker.getPipelineLatencyMs());
                 }
             }            
             ImGui::Dummy(ImVec2(0, 20));
@@ -148,6 +171,9 @@ void GuiManager::drawPerformUi(AppComponents &c)
 
             if (ImGui::CollapsingHeader("Saved States", ImGuiTreeNodeFlags_DefaultOpen))
             {
+                ImGui::SetNextItemWidth(120);
+                ImGui::SliderInt("Preload Budget (MB)", &c.identity.preloadBudgetMB, 0, 2048);
+                if (ImGui::IsItemDeactivatedAfterEdit()) c.identity.save();
                 if (ImGui::BeginTable("StatesTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
                 {
                     ImGui::TableSetupColumn("ID", ImGuiTableColumnFlags_WidthFixed, 30.0f);
@@ -183,10 +209,12 @@ void GuiManager::drawPerformUi(AppComponents &c)
             
             static int selectedStateForTrigger = 0;
             static char keyInput[2] = "";
+            static int triggerQuantize = QUANTIZE_NONE;
+            static const char *quantizeNames = "Now\0Beat\0Bar\0";
 
             if(ImGui::SmallButton("NEW##Trig")) {
                 if(keyInput[0] != '\0' && !c.stateMgr.states.empty()) {
-                    c.stateMgr.addTrigger(keyInput[0], selectedStateForTrigger);
+                    c.stateMgr.addTrigger(keyInput[0], selectedStateForTrigger, (Quantize)triggerQuantize);
                     keyInput[0] = '\0';
                 }
             }
@@ -206,11 +234,14 @@ void GuiManager::drawPerformUi(AppComponents &c)
                     }
                     ImGui::EndCombo();
                 }
+                ImGui::SetNextItemWidth(80);
+                ImGui::Combo("Quantize", &triggerQuantize, quantizeNames);
 
-                if (ImGui::BeginTable("TriggersTable", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+                if (ImGui::BeginTable("TriggersTable", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
                 {
                     ImGui::TableSetupColumn("State Target");
                     ImGui::TableSetupColumn("Inputs (Key)");
+                    ImGui::TableSetupColumn("Quantize", ImGuiTableColumnFlags_WidthFixed, 70.0f);
                     ImGui::TableSetupColumn("Actions", ImGuiTableColumnFlags_WidthFixed, 60.0f);
                     ImGui::TableHeadersRow();
 
@@ -226,8 +257,16 @@ void GuiManager::drawPerformUi(AppComponents &c)
                         char kChar = (char)c.stateMgr.triggers[i].key;
                         ImGui::Text("Key '%c'", kChar);
 
-                        ImGui::TableNextColumn();
                         ImGui::PushID(i);
+                        ImGui::TableNextColumn();
+                        int q = c.stateMgr.triggers[i].quantize;
+                        ImGui::SetNextItemWidth(-1);
+                        if (ImGui::Combo("##quantize", &q, quantizeNames)) {
+                            c.stateMgr.triggers[i].quantize = (Quantize)q;
+                            c.stateMgr.save();
+                        }
+
+                        ImGui::TableNextColumn();
                         if(ImGui::SmallButton("DEL")) {
                             c.stateMgr.removeTrigger(i);
                         }
@@ -241,20 +280,41 @@ void GuiManager::drawPerformUi(AppComponents &c)
             ImGui::TextDisabled("SETTINGS");
             ImGui::Separator();
 
+            pollLevels(c);
             if (ImGui::CollapsingHeader("Audio Input Settings", ImGuiTreeNodeFlags_DefaultOpen))
             {
                 ImGui::Dummy(ImVec2(0,5));
-                static float gain = 0.5f;
-                static int deviceId = 0;
                 static bool listen = true;
                 
-                ImGui::Combo("Device", &deviceId, "Default Input\0USB Mic\0Virtual Cable\0");
-                ImGui::SliderFloat("Gain", &gain, 0.0f, 1.0f);
+                const auto &devices = c.core.getInputDevices();
+                string current = c.identity.audioDevice.empty() ? "Default Input" : c.identity.audioDevice;
+                if (ImGui::BeginCombo("Device", current.c_str())) {
+                    if (ImGui::Selectable("Default Input", c.identity.audioDevice.empty()) && !c.identity.audioDevice.empty()) {
+                        c.identity.audioDevice = "";
+                        c.identity.save();
+                        c.core.setupAudio();
+                    }
+                    for (size_t i = 0; i < devices.size(); i++) {
+                        ImGui::PushID((int)i);
+                        const string &name = devices[i].name;
+                        if (ImGui::Selectable(name.c_str(), name == c.identity.audioDevice) && name != c.identity.audioDevice) {
+                            c.identity.audioDevice = name;
+                            c.identity.save();
+                            c.core.setupAudio();
+                        }
+                        ImGui::PopID();
+                    }
+                    ImGui::EndCombo();
+                }
+                ImGui::SliderFloat("Gain", &c.identity.audioGain, 0.0f, 4.0f);
+                if (ImGui::IsItemDeactivatedAfterEdit()) c.identity.save();
                 ImGui::Checkbox("Monitor / Listen", &listen);
                 
-                ImGui::PlotHistogram("Levels", [](void*, int idx) -> float { 
-                    return sin(idx * 0.1f) * 0.5f + 0.5f; 
-                }, NULL, 50, 0, NULL, 0.0f, 1.0f, ImVec2(0, 60));
+                // Peak level over the last 2 seconds, -60..0 dBFS
+                ImGui::PlotHistogram("Levels", levelHistory.data(), (int)levelHistory.size(), 0, NULL, 0.0f, 1.0f, ImVec2(0, 60));
+                ImGui::TextDisabled("%d Hz, RMS %.1f dB, peak %.1f dB", c.tracker.getInputRate(), LevelMeter::toDb(lastLevel.rms), LevelMeter::toDb(lastLevel.peak));
+                if (hasSpectrum && c.tracker.getEnabled())
+                    ImGui::PlotHistogram("Spectrum", lastSpectrum.bands, LevelMeter::NUM_BANDS, 0, NULL, 0.0f, FLT_MAX, ImVec2(0, 40));
                 
                 ImGui::Dummy(ImVec2(0,10));
             }
@@ -288,6 +348,26 @@ void GuiManager::drawPerformUi(AppComponents &c)
     gui.end(); 
 }
 
+// Drains the tracker's meter feed every frame, shown or not, so the plot
+// never starts from stale readings
+void GuiManager::pollLevels(AppComponents &c)
+{
+    LevelMeter::Reading readings[32];
+    size_t n;
+    while ((n = c.tracker.popLevels(readings, 32)) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            levelHistory.erase(levelHistory.begin());
+            levelHistory.push_back(ofClamp((LevelMeter::toDb(readings[i].peak) + 60.0f) / 60.0f, 0.0f, 1.0f));
+        }
+        lastLevel = readings[n - 1];
+    }
+    LevelMeter::Spectrum spectra[8];
+    while ((n = c.tracker.popSpectra(spectra, 8)) > 0) {
+        lastSpectrum = spectra[n - 1];
+        hasSpectrum = true;
+    }
+}
+
 void GuiManager::drawEditingUI(AppComponents &c)
 {
     gui.begin();
@@ -354,6 +434,15 @@ void GuiManager::drawEditingUI(AppComponents &c)
                     (void)system(("xdg-open \"" + mDir + "\"").c_str());
                 #endif
             }
+            const ContentCacheStats &cs = c.warper.contents.getStats();
+            ImGui::Text("Cache: %.0f / %.0f MB, %d loaded (%d pinned, %d preloaded)",
+                        cs.residentBytes / 1048576.0, cs.budgetBytes / 1048576.0, cs.resident, cs.pinned, cs.preloaded);
+            ImGui::Text("Hits: %llu  Misses: %llu  Evictions: %llu",
+                        (unsigned long long)cs.hits, (unsigned long long)cs.misses, (unsigned long long)cs.evictions);
+            ImGui::SetNextItemWidth(120);
+            ImGui::SliderInt("Cache Budget (MB)", &c.identity.cacheBudgetMB, 64, 8192);
+            if (ImGui::IsItemDeactivatedAfterEdit()) c.identity.save();
+
             vector<string> files = c.watcher.getAllItems();
             if (files.empty())
                 ImGui::Text("No media files found.");
@@ -379,6 +468,17 @@ void GuiManager::drawEditingUI(AppComponents &c)
                 {
                     ImGui::TextColored(ImVec4(0, 1, 0, 1), "%s [Synced]", f.c_str());
                 }
+
+                const VideoPLL *pll = c.warper.contents.getSyncPLL(f);
+                if (pll && pll->getHistory().size() > 1)
+                {
+                    vector<float> hist = pll->getHistory();
+                    string overlay = "phase " + ofToString(pll->getPhaseError(), 3) + " rms " + ofToString(pll->getRmsError(), 3) +
+                                     " seeks " + ofToString(pll->getSeekCount());
+                    ImGui::PushID(f.c_str());
+                    ImGui::PlotLines("##phase", hist.data(), (int)hist.size(), 0, overlay.c_str(), -0.5f, 0.5f, ImVec2(0, 40));
+                    ImGui::PopID();
+                }
             }
             ImGui::TreePop();
         }
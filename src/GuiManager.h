@@ -2,6 +2,7 @@
 #include "ofMain.h"
 #include "ofxImGui.h"
 #include "AppComponents.h"
+#include "LevelMeter.h"
 
 class GuiManager {
 public:
@@ -15,6 +16,13 @@ private:
     string lastIdOwner = "";
     string lastSurfaceId = "";
 
+    // Input meter history for the Levels plot, newest last
+    vector<float> levelHistory = vector<float>(100, 0.0f);
+    LevelMeter::Reading lastLevel = {0.0f, 0.0f};
+    LevelMeter::Spectrum lastSpectrum = {};
+    bool hasSpectrum = false;
+    void pollLevels(AppComponents &c);
+
     void drawPerformUi(AppComponents &c);
     void drawEditingUI(AppComponents &c);
 };
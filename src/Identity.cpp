@@ -14,6 +14,12 @@ void Identity::setup(string _configPath, bool bHeadless) {
             fullscreen = config["fullscreen"].get<bool>();
             if (!bHeadless) ofSetFullscreen(fullscreen);
         }
+        preloadBudgetMB = config.value("preloadBudgetMB", preloadBudgetMB);
+        cacheBudgetMB = config.value("cacheBudgetMB", cacheBudgetMB);
+        scheduleLookaheadMs = config.value("scheduleLookaheadMs", scheduleLookaheadMs);
+        trackerLatencyBudgetMs = config.value("trackerLatencyBudgetMs", trackerLatencyBudgetMs);
+        audioDevice = config.value("audioDevice", audioDevice);
+        audioGain = config.value("audioGain", audioGain);
     }
 
     if(myId.length() != 8) {
@@ -35,6 +41,12 @@ void Identity::save() {
     ofJson config;
     config["identity"]["id"] = myId;
     config["fullscreen"] = fullscreen;
+    config["preloadBudgetMB"] = preloadBudgetMB;
+    config["cacheBudgetMB"] = cacheBudgetMB;
+    config["scheduleLookaheadMs"] = scheduleLookaheadMs;
+    config["trackerLatencyBudgetMs"] = trackerLatencyBudgetMs;
+    config["audioDevice"] = audioDevice;
+    config["audioGain"] = audioGain;
     ofSaveJson(configPath, config);
 }
 
@@ -5,6 +5,12 @@ class Identity {
 public:
     string myId;
     bool fullscreen = false;
+    int preloadBudgetMB = 256;
+    int cacheBudgetMB = 1024;
+    int scheduleLookaheadMs = 150;
+    int trackerLatencyBudgetMs = 0;
+    string audioDevice; // input device name, empty for the system default
+    float audioGain = 1.0f;
     string configPath;
 
     void setup(string _configPath, bool bHeadless = false);
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+// Rolling latency percentiles over the last `window` samples. add() is called
+// from one worker thread and recomputes the percentiles every `publishEvery`
+// samples into preallocated scratch; readers on other threads only load
+// atomics, so the GUI never waits on the worker.
+class LatencyStats {
+public:
+    struct Summary {
+        float p50 = 0, p95 = 0, p99 = 0, max = 0; // microseconds
+        uint64_t count = 0;
+    };
+
+    explicit LatencyStats(size_t window = 512, size_t publishEvery = 50)
+        : samples(window, 0.0f), scratch(window), publishEvery(std::max<size_t>(1, publishEvery)) {}
+
+    // Worker thread only
+    void add(int64_t ns) {
+        samples[pos] = ns / 1000.0f;
+        pos = (pos + 1) % samples.size();
+        if (filled < samples.size()) filled++;
+        total++;
+        if (total % publishEvery == 0 || total < publishEvery) publish();
+    }
+
+    Summary get() const {
+        Summary s;
+        s.p50 = p50.load(std::memory_order_relaxed);
+        s.p95 = p95.load(std::memory_order_relaxed);
+        s.p99 = p99.load(std::memory_order_relaxed);
+        s.max = pmax.load(std::memory_order_relaxed);
+        s.count = count.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    std::vector<float> samples;
+    std::vector<float> scratch;
+    size_t publishEvery;
+    size_t pos = 0;
+    size_t filled = 0;
+    uint64_t total = 0;
+    std::atomic<float> p50{0}, p95{0}, p99{0}, pmax{0};
+    std::atomic<uint64_t> count{0};
+
+    float rank(double q) {
+        size_t k = std::min(filled - 1, (size_t)(q * (filled - 1) + 0.5));
+        std::nth_element(scratch.begin(), scratch.begin() + k, scratch.begin() + filled);
+        return scratch[k];
+    }
+
+    void publish() {
+        std::copy(samples.begin(), samples.begin() + filled, scratch.begin());
+        p50.store(rank(0.50), std::memory_order_relaxed);
+        p95.store(rank(0.95), std::memory_order_relaxed);
+        p99.store(rank(0.99), std::memory_order_relaxed);
+        pmax.store(*std::max_element(scratch.begin(), scratch.begin() + filled), std::memory_order_relaxed);
+        count.store(total, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include "SpscRing.h"
+
+// Input level feed for the GUI. The audio callback accumulates RMS and peak
+// over fixed intervals and pushes one reading per interval into a lock-free
+// ring; the GUI drains it once per frame. Band energies, when the beat
+// tracker's front-end is running, come through a second ring, decimated to
+// a few bands and one frame every few hops.
+class LevelMeter {
+public:
+    struct Reading {
+        float rms;
+        float peak;
+    };
+
+    static const int NUM_BANDS = 16;
+    struct Spectrum {
+        float bands[NUM_BANDS];
+    };
+
+    LevelMeter() : readings(64), spectra(16) {}
+
+    // Producer side. Interval length only; the rings are never reallocated,
+    // so the GUI may keep reading across a device change.
+    void setSampleRate(int rate, float intervalMs = 20.0f) {
+        interval = std::max(1, (int)(rate * intervalMs / 1000.0f));
+        count = 0;
+        sumSquares = 0.0f;
+        peak = 0.0f;
+    }
+
+    // Audio thread. Wait-free; readings the GUI hasn't taken are dropped.
+    void process(const float *mono, size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            float s = mono[i];
+            sumSquares += s * s;
+            peak = std::max(peak, std::abs(s));
+            if (++count < interval) continue;
+            Reading r = {std::sqrt(sumSquares / count), peak};
+            readings.write(&r, 1);
+            count = 0;
+            sumSquares = 0.0f;
+            peak = 0.0f;
+        }
+    }
+
+    // Analysis thread. Averages n log band energies into NUM_BANDS groups.
+    void processBands(const float *bands, int n) {
+        if (n <= 0) return;
+        Spectrum s;
+        for (int g = 0; g < NUM_BANDS; g++) {
+            int lo = g * n / NUM_BANDS, hi = std::max(lo + 1, (g + 1) * n / NUM_BANDS);
+            float sum = 0.0f;
+            for (int b = lo; b < hi && b < n; b++) sum += bands[b];
+            s.bands[g] = sum / (hi - lo);
+        }
+        spectra.write(&s, 1);
+    }
+
+    // GUI thread
+    size_t popReadings(Reading *out, size_t max) { return readings.read(out, max); }
+    size_t popSpectra(Spectrum *out, size_t max) { return spectra.read(out, max); }
+
+    static float toDb(float level) { return 20.0f * std::log10(std::max(level, 1e-6f)); }
+
+private:
+    SpscRing<Reading> readings;
+    SpscRing<Spectrum> spectra;
+    int interval = 441;
+    int count = 0;
+    float sumSquares = 0.0f;
+    float peak = 0.0f;
+};
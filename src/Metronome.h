@@ -3,53 +3,73 @@
 #ifndef TEST_MODE
 #include "ofMain.h"
 #endif
+#include <cmath>
+#include <vector>
+#include "ClusterClock.h"
+#include "Timebase.h"
 
 class Metronome {
 public:
     float bpm = 120.0f;
-    double referenceTime = 0.0; // Timestamp of a Beat 1
+    int64_t referenceTimeNs = 0; // Timestamp of a Beat 1, in cluster ns when a clock is set
     int beatsPerBar = 4;
+    // Shared cluster timebase; without one the local steady clock is used
+    const ClusterClock *clock = nullptr;
     
     // Tap Tempo helper
-    std::vector<double> tapTimes;
+    std::vector<int64_t> tapTimes;
+
+    int64_t nowNs() const {
+        if (clock) return clock->nowNs();
+        return Timebase::nowNs();
+    }
 
     void setup() {
-        referenceTime = ofGetElapsedTimeMillis();
+        referenceTimeNs = nowNs();
     }
 
-    void tap() {
-        double now = ofGetElapsedTimeMillis();
+    void tap() { tapAt(nowNs()); }
+
+    void tapAt(int64_t now) {
         tapTimes.push_back(now);
         if (tapTimes.size() > 4) tapTimes.erase(tapTimes.begin());
 
         if (tapTimes.size() >= 2) {
-            double totalDiff = 0;
-            for (size_t i = 1; i < tapTimes.size(); i++) {
-                totalDiff += (tapTimes[i] - tapTimes[i-1]);
-            }
-            float avgDiff = totalDiff / (tapTimes.size() - 1);
-            bpm = 60000.0f / avgDiff;
+            int64_t totalDiff = tapTimes.back() - tapTimes.front();
+            double avgDiff = (double)totalDiff / (tapTimes.size() - 1);
+            bpm = (float)(Timebase::NS_PER_MIN / avgDiff);
         }
         // Always reset phase to the last tap as a new "Beat 1"
-        referenceTime = now;
+        referenceTimeNs = now;
+    }
+
+    // Beats since the reference; double so the phase stays exact after weeks
+    double getBeatAt(int64_t timeNs) const {
+        return Timebase::beatsBetween(referenceTimeNs, timeNs, bpm);
+    }
+
+    // Timestamp at which the metronome reaches `beat`
+    int64_t getTimeOfBeat(double beat) const {
+        return referenceTimeNs + Timebase::beatsToNs(beat, bpm);
     }
 
-    float getBeat() {
-        double elapsed = ofGetElapsedTimeMillis() - referenceTime;
-        double beatDuration = 60000.0 / bpm;
-        return (float)(elapsed / beatDuration);
+    double getBeat() const {
+        return getBeatAt(nowNs());
     }
 
-    int getBeatInBar() {
-        return ((int)std::floor(getBeat()) % beatsPerBar) + 1;
+    int getBeatInBar() const {
+        int64_t beat = (int64_t)std::floor(getBeat());
+        int64_t inBar = beat % beatsPerBar;
+        if (inBar < 0) inBar += beatsPerBar;
+        return (int)inBar + 1;
     }
 
-    float getPhase() {
-        float beat = getBeat();
-        return beat - std::floor(beat);
+    float getPhase() const {
+        double beat = getBeat();
+        return (float)(beat - std::floor(beat));
     }
 
-    bool isBeatFirst() {
+    bool isBeatFirst() const {
         return getBeatInBar() == 1;
     }
 };
@@ -128,17 +128,30 @@ void Network::sendWarpScaleAll(string ownerId, int surfIdx, int mode, float fact
     sendSafe((const char *)&p, sizeof(WarpScaleAllPacket));
 }
 
-void Network::sendMetronome(float bpm, double refTime, int beats)
+void Network::sendMetronome(float bpm, int64_t refTimeNs, int beats)
 {
     if (!isAuthority() || inErrorState) return;
     MetronomePacket p;
     fillHeader(p.header, PKT_METRONOME);
     p.bpm = bpm;
-    p.referenceTime = refTime;
+    p.referenceTimeNs = refTimeNs;
     p.beatsPerBar = (uint8_t)beats;
     sendSafe((const char *)&p, sizeof(MetronomePacket));
 }
 
+void Network::sendBeat(uint32_t index, int64_t beatTimeNs, float confidence, int beatInBar, bool downbeat)
+{
+    if (!isAuthority() || inErrorState) return;
+    BeatPacket p;
+    fillHeader(p.header, PKT_BEAT);
+    p.beatIndex = index;
+    p.beatTimeNs = beatTimeNs;
+    p.confidence = confidence;
+    p.beatInBar = (uint8_t)beatInBar;
+    p.downbeat = downbeat ? 1 : 0;
+    sendSafe((const char *)&p, sizeof(BeatPacket));
+}
+
 void Network::sendFullscreen(string targetId, bool enabled)
 {
     if (!isAuthority() || inErrorState) return;
@@ -165,6 +178,31 @@ void Network::sendWarp(string ownerId, int surfIdx, int mode, int ptIdx, float x
     sendSafe((const char *)&p, sizeof(WarpPacket));
 }
 
+void Network::sendWarpSelection(string ownerId, int surfIdx, int mode, int op, float a, float b, glm::vec2 pivot, const vector<int> &indices)
+{
+    if (!isAuthority() || inErrorState || indices.empty()) return;
+    size_t count = std::min(indices.size(), (size_t)((65000 - sizeof(WarpSelectionPacket)) / sizeof(uint16_t)));
+    vector<char> buf(sizeof(WarpSelectionPacket) + count * sizeof(uint16_t));
+    WarpSelectionPacket *p = (WarpSelectionPacket *)buf.data();
+    fillHeader(p->header, PKT_WARP_SELECTION);
+    strncpy(p->ownerId, ownerId.c_str(), 8);
+    p->ownerId[8] = 0;
+    p->surfaceIndex = surfIdx;
+    p->mode = mode;
+    p->op = op;
+    p->a = a;
+    p->b = b;
+    p->pivotX = pivot.x;
+    p->pivotY = pivot.y;
+    p->count = (uint16_t)count;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t idx = (uint16_t)indices[i];
+        memcpy(buf.data() + sizeof(WarpSelectionPacket) + i * sizeof(uint16_t), &idx, sizeof(uint16_t));
+    }
+    sendSafe(buf.data(), buf.size());
+}
+
 void Network::sendStructure(string jsonStr)
 {
     if (!isAuthority() || inErrorState) return;
@@ -176,6 +214,18 @@ void Network::sendStructure(string jsonStr)
     sendSafe(buf.data(), buf.size());
 }
 
+void Network::sendStateSchedule(int64_t targetTimeNs, string jsonStr)
+{
+    if (!isAuthority() || inErrorState) return;
+    StateSchedulePacket p;
+    fillHeader(p.header, PKT_STATE_SCHEDULE);
+    p.targetTimeNs = targetTimeNs;
+    vector<char> buf(sizeof(StateSchedulePacket) + jsonStr.length());
+    memcpy(buf.data(), &p, sizeof(StateSchedulePacket));
+    memcpy(buf.data() + sizeof(StateSchedulePacket), jsonStr.c_str(), jsonStr.length());
+    sendSafe(buf.data(), buf.size());
+}
+
 void Network::offerFile(string filename)
 {
     if (!isAuthority()) return;
@@ -46,10 +46,13 @@ public:
     void sendHeartbeat();
     void sendWarpMoveAll(string ownerId, int surfIdx, int mode, float dx, float dy);
     void sendWarpScaleAll(string ownerId, int surfIdx, int mode, float factor, float cx, float cy);
-    void sendMetronome(float bpm, double refTime, int beats);
+    void sendMetronome(float bpm, int64_t refTimeNs, int beats);
+    void sendBeat(uint32_t index, int64_t beatTimeNs, float confidence, int beatInBar, bool downbeat);
     void sendFullscreen(string targetId, bool enabled);
     void sendWarp(string ownerId, int surfIdx, int mode, int ptIdx, float x, float y);
+    void sendWarpSelection(string ownerId, int surfIdx, int mode, int op, float a, float b, glm::vec2 pivot, const vector<int> &indices);
     void sendStructure(string jsonStr);
+    void sendStateSchedule(int64_t targetTimeNs, string jsonStr);
     void offerFile(string filename);
 
     int receive(char *buf, int max);
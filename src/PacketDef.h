@@ -20,7 +20,12 @@ enum PacketType : uint8_t {
     PKT_WARP_MOVE_ALL = 7, 
     PKT_WARP_SCALE_ALL = 8,
     PKT_METRONOME = 9,
-    PKT_FULLSCREEN = 10
+    PKT_FULLSCREEN = 10,
+    PKT_WARP_SELECTION = 11,
+    PKT_TIME_REQUEST = 12,
+    PKT_TIME_RESPONSE = 13,
+    PKT_STATE_SCHEDULE = 14,
+    PKT_BEAT = 15
 };
 
 enum EditMode : int {
@@ -29,6 +34,12 @@ enum EditMode : int {
     EDIT_MAPPING = 2
 };
 
+enum SelectionOp : uint8_t {
+    SEL_TRANSLATE = 0, // a = dx, b = dy
+    SEL_SCALE     = 1, // a = factor
+    SEL_ROTATE    = 2  // a = radians, b = viewport aspect (w / h)
+};
+
 #pragma pack(push, 1)
 struct PacketHeader {
     uint8_t id = PACKET_ID;
@@ -97,11 +108,56 @@ struct WarpScaleAllPacket {
     float centroidY;
 };
 
+// Followed by `count` uint16_t control point indices
+struct WarpSelectionPacket {
+    PacketHeader header;
+    char ownerId[9];
+    uint8_t surfaceIndex;
+    uint8_t mode;
+    uint8_t op;
+    float a;
+    float b;
+    float pivotX;
+    float pivotY;
+    uint16_t count;
+};
+
 struct MetronomePacket {
     PacketHeader header;
     float bpm;
-    double referenceTime; // ofGetElapsedTimeMillis() of Beat 1
+    int64_t referenceTimeNs; // Cluster time (ns) of Beat 1
     uint8_t beatsPerBar;
 };
 
+// Followed by the structure JSON; every peer loads it at targetTimeNs
+struct StateSchedulePacket {
+    PacketHeader header;
+    int64_t targetTimeNs; // Cluster time (ns), usually a beat or bar boundary
+};
+
+// One beat detected by the master's tracker, sent as soon as it is drained
+struct BeatPacket {
+    PacketHeader header;
+    uint32_t beatIndex;     // running count since the tracker started
+    int64_t beatTimeNs;     // Cluster time (ns) of the beat, latency-compensated
+    float confidence;       // 0..1
+    uint8_t beatInBar;      // 0 = downbeat
+    uint8_t downbeat;
+};
+
+// Clock sync: peers stamp t0 with their local clock, the authority echoes it
+// with its own receive (t1) and send (t2) times. All values in ns.
+struct TimeRequestPacket {
+    PacketHeader header;
+    int64_t t0;
+};
+
+struct TimeResponsePacket {
+    PacketHeader header;
+    char requesterId[9];
+    int64_t t0;
+    int64_t t1;
+    int64_t t2;
+};
+
 #pragma pack(pop)
\ No newline at end of file
@@ -0,0 +1,159 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+// Streaming rational resampler, inRate -> outRate, for feeding the beat
+// tracker from devices running at their native rate.
+//
+// The ratio is reduced to L / M (44100 -> 22050 is 1 / 2, 48000 -> 22050 is
+// 147 / 320). Conceptually the input is upsampled by L, low-pass filtered and
+// decimated by M; the polyphase form only evaluates the L-th branch of the
+// filter that lands on each output, so an output costs one dot product of
+// `taps` coefficients over contiguous input. The branches are stored
+// reversed so that product is a flat loop the compiler vectorizes (SSE/NEON
+// at -O2/-O3; no intrinsics, so it builds everywhere oF does).
+//
+// Allocation-free after setup() as long as blocks fit maxBlock.
+class PolyphaseResampler {
+public:
+    // zeroCrossings: half-length of the windowed sinc in output samples;
+    // more gives a sharper anti-alias filter. rolloff: cutoff as a share of
+    // the lower Nyquist frequency.
+    void setup(int inputRate, int outputRate, size_t maxBlock, int zeroCrossings = 16, double rolloff = 0.9) {
+        inRate = inputRate;
+        outRate = outputRate;
+        int g = std::gcd(inRate, outRate);
+        up = outRate / g;
+        down = inRate / g;
+
+        // Cutoff relative to the input Nyquist frequency; the sinc's zero
+        // crossings are 1 / cutoff input samples apart
+        double cutoff = rolloff * std::min(1.0, (double)up / down);
+        taps = 2 * (int)std::ceil(zeroCrossings * std::max(1.0, (double)down / up));
+        taps = std::max(4, (taps + 3) & ~3); // whole SIMD lanes
+        const int length = taps * up;
+        const double centre = (length - 1) / 2.0;
+        const double beta = 8.0; // Kaiser window, ~80 dB stopband
+
+        coeffs.assign((size_t)length, 0.0f);
+        for (int p = 0; p < up; p++) {
+            for (int k = 0; k < taps; k++) {
+                // Tap k of branch p multiplies x[base - k]; stored reversed.
+                // The gain of L makes up for the zeros the upsampling inserts.
+                double n = p + (double)k * up - centre;
+                double x = cutoff * n / up;
+                double sinc = n == 0 ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+                double r = 2.0 * (p + (double)k * up) / (length - 1) - 1.0;
+                double w = besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+                coeffs[(size_t)p * taps + (taps - 1 - k)] = (float)(cutoff * sinc * w);
+            }
+        }
+
+        history.assign((size_t)taps - 1 + maxBlock, 0.0f);
+        capacity = maxBlock;
+        reset();
+    }
+
+    // Clears the filter history, as if preceded by silence
+    void reset() {
+        std::fill(history.begin(), history.end(), 0.0f);
+        phase = 0;
+        outputLag = getDelay();
+    }
+
+    // Resamples n input samples, appending up to maxOut outputs to out.
+    // Returns the number written; maxOutput(n) is always enough.
+    size_t process(const float *in, size_t n, float *out, size_t maxOut) {
+        size_t written = 0;
+        while (n > 0) {
+            size_t block = std::min(n, capacity);
+            written += processBlock(in, block, out + written, maxOut - written);
+            in += block;
+            n -= block;
+        }
+        return written;
+    }
+
+    size_t maxOutput(size_t n) const { return up == down ? n : n * up / down + 2; }
+    int getInputRate() const { return inRate; }
+    int getOutputRate() const { return outRate; }
+    bool isPassthrough() const { return up == down; }
+    // Group delay of the filter, in input samples
+    double getDelay() const { return up == down ? 0.0 : (taps * up - 1) / 2.0 / up; }
+    // How far, in input samples, the newest output lags the newest input:
+    // the group delay plus any input consumed since that output's position
+    double getOutputLag() const { return outputLag; }
+
+private:
+    int inRate = 1, outRate = 1;
+    int up = 1, down = 1;
+    int taps = 2;
+    size_t capacity = 0;
+    std::vector<float> coeffs;  // [up][taps], each branch reversed
+    std::vector<float> history; // taps - 1 samples of past input, then the block
+    // Next output's position on the upsampled grid, relative to the first
+    // new sample of the next block
+    long long phase = 0;
+    double outputLag = 0.0;
+
+    static double besselI0(double x) {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; k++) {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < 1e-12 * sum) break;
+        }
+        return sum;
+    }
+
+    size_t processBlock(const float *in, size_t n, float *__restrict out, size_t maxOut) {
+        if (up == down) {
+            size_t count = std::min(n, maxOut);
+            std::copy(in, in + count, out);
+            return count;
+        }
+        const size_t keep = (size_t)taps - 1;
+        std::copy(in, in + n, history.begin() + keep);
+
+        size_t written = 0;
+        const long long end = (long long)n * up;
+        long long t = phase;
+        long long last = -1;
+        for (; t < end && written < maxOut; t += down) {
+            long long base = t / up;
+            int p = (int)(t % up);
+            const float *__restrict x = history.data() + base;
+            const float *__restrict h = coeffs.data() + (size_t)p * taps;
+            // Four partial sums, so the loop vectorizes without -ffast-math
+            float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for (int k = 0; k < taps; k += 4)
+                for (int j = 0; j < 4; j++) acc[j] += h[k + j] * x[k + j];
+            out[written++] = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            last = t;
+        }
+        phase = t - end;
+        if (last >= 0) outputLag = (end - last) / (double)up - 1.0 + getDelay();
+        else outputLag += n;
+
+        // The tail becomes the next block's history
+        std::copy(history.begin() + n, history.begin() + n + keep, history.begin());
+        return written;
+    }
+};
+
+// Averages interleaved channels into mono
+inline void downmix(const float *__restrict in, float *__restrict out, size_t frames, size_t channels) {
+    if (channels == 1) {
+        std::copy(in, in + frames, out);
+        return;
+    }
+    const float norm = 1.0f / channels;
+    for (size_t i = 0; i < frames; i++) {
+        float sum = 0.0f;
+        for (size_t c = 0; c < channels; c++) sum += in[i * channels + c];
+        out[i] = sum * norm;
+    }
+}
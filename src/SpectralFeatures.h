@@ -0,0 +1,158 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// Filterbank stored as one contiguous run of weights per band. Log-spaced
+// bands only cover a handful of FFT bins each, so a dense [band][bin] matrix
+// is almost entirely zeros; this keeps just the non-zero span of each band.
+class SparseFilterbank {
+public:
+    void reset(int bins) {
+        numBins = bins;
+        start.clear();
+        offset.assign(1, 0);
+        weights.clear();
+    }
+
+    // Adds a band whose weights start at firstBin. Zero weights at either end
+    // are trimmed.
+    void addBand(int firstBin, const std::vector<float> &w) {
+        size_t lo = 0, hi = w.size();
+        while (lo < hi && w[lo] == 0.0f) lo++;
+        while (hi > lo && w[hi - 1] == 0.0f) hi--;
+        int first = std::max(0, firstBin + (int)lo);
+        int last = std::min(numBins, firstBin + (int)hi);
+        start.push_back(first);
+        for (int b = first; b < last; b++) weights.push_back(w[b - firstBin]);
+        offset.push_back((int)weights.size());
+    }
+
+    // Triangular filters on a log-frequency grid, built the way madmom's
+    // LogarithmicFilterbank does it (BeatNet's training front-end):
+    //  - centre frequencies fref * 2^(k / bandsPerOctave) within [fmin, fmax]
+    //  - each snapped to the nearest FFT bin, duplicates removed
+    //  - consecutive bin triples (start, centre, stop) form one triangle
+    //    covering [start, stop), optionally normalized to unit area
+    // binFrequencies are the centre frequencies of the spectrum's bins.
+    static SparseFilterbank logarithmic(const std::vector<double> &binFrequencies, int bandsPerOctave = 24,
+                                        double fmin = 30.0, double fmax = 17000.0, double fref = 440.0,
+                                        bool normalize = true) {
+        std::vector<double> freqs;
+        double left = std::floor(std::log2(fmin / fref) * bandsPerOctave);
+        double right = std::ceil(std::log2(fmax / fref) * bandsPerOctave);
+        for (double k = left; k < right; k++) {
+            double f = fref * std::pow(2.0, k / bandsPerOctave);
+            if (f >= fmin && f <= fmax) freqs.push_back(f);
+        }
+
+        const int n = (int)binFrequencies.size();
+        std::vector<int> bins;
+        for (double f : freqs) {
+            int idx = (int)(std::lower_bound(binFrequencies.begin(), binFrequencies.end(), f) - binFrequencies.begin());
+            idx = std::max(1, std::min(n - 1, idx));
+            if (f - binFrequencies[idx - 1] < binFrequencies[idx] - f) idx--;
+            if (bins.empty() || bins.back() != idx) bins.push_back(idx);
+        }
+
+        SparseFilterbank fb;
+        fb.reset(n);
+        for (size_t i = 0; i + 2 < bins.size(); i++) {
+            int start = bins[i], center = bins[i + 1], stop = bins[i + 2];
+            if (stop - start < 2) {
+                center = start;
+                stop = start + 1;
+            }
+            int rise = center - start, fall = stop - center;
+            std::vector<float> w(stop - start);
+            double sum = 0;
+            for (int j = 0; j < rise; j++) sum += w[j] = (float)((double)j / rise);
+            for (int j = 0; j < fall; j++) sum += w[rise + j] = (float)(1.0 - (double)j / fall);
+            if (normalize && sum > 0)
+                for (auto &v : w) v = (float)(v / sum);
+            fb.addBand(start, w);
+        }
+        return fb;
+    }
+
+    // Bin centre frequencies as madmom labels them: k * sampleRate / (2 * numBins)
+    static std::vector<double> fftFrequencies(int numBins, double sampleRate) {
+        std::vector<double> f(numBins);
+        for (int k = 0; k < numBins; k++) f[k] = k * sampleRate / (2.0 * numBins);
+        return f;
+    }
+
+    static SparseFilterbank fromDense(const std::vector<std::vector<float>> &dense, int bins) {
+        SparseFilterbank fb;
+        fb.reset(bins);
+        for (auto &row : dense) fb.addBand(0, row);
+        return fb;
+    }
+
+    int getNumBands() const { return (int)start.size(); }
+    int getNumBins() const { return numBins; }
+    int getNumWeights() const { return (int)weights.size(); }
+    int getStart(int band) const { return start[band]; }
+    int getWidth(int band) const { return offset[band + 1] - offset[band]; }
+    const float *getWeights(int band) const { return weights.data() + offset[band]; }
+
+    // bands[b] = sum of spectrum[start..] * weights; spectrum has numBins values
+    void apply(const float *spectrum, float *bands) const {
+        const int n = getNumBands();
+        for (int b = 0; b < n; b++) {
+            const float *s = spectrum + start[b];
+            const float *w = weights.data() + offset[b];
+            const int len = offset[b + 1] - offset[b];
+            // Independent partial sums so the MACs pipeline without -ffast-math
+            float a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+            int i = 0;
+            for (; i + 4 <= len; i += 4) {
+                a0 += s[i] * w[i];
+                a1 += s[i + 1] * w[i + 1];
+                a2 += s[i + 2] * w[i + 2];
+                a3 += s[i + 3] * w[i + 3];
+            }
+            for (; i < len; i++) a0 += s[i] * w[i];
+            bands[b] = (a0 + a1) + (a2 + a3);
+        }
+    }
+
+private:
+    int numBins = 0;
+    std::vector<int> start;     // first bin of each band
+    std::vector<int> offset;    // band b's weights are [offset[b], offset[b + 1])
+    std::vector<float> weights;
+};
+
+// Per-hop spectral stages, written as flat loops over contiguous arrays so
+// the compiler vectorizes them.
+namespace SpectralOps {
+
+// |X| from interleaved (re, im) pairs, e.g. kiss_fft_cpx[]
+inline void magnitudes(const float *__restrict cpx, float *__restrict out, int n) {
+    for (int i = 0; i < n; i++) {
+        float re = cpx[2 * i], im = cpx[2 * i + 1];
+        out[i] = std::sqrt(re * re + im * im);
+    }
+}
+
+inline void window(const float *__restrict in, const float *__restrict win, float *__restrict out, int n) {
+    for (int i = 0; i < n; i++) out[i] = in[i] * win[i];
+}
+
+// out = log10(1 + in), madmom's LogarithmicSpectrogram with mul=1, add=1
+inline void logCompress(const float *in, float *out, int n) {
+    const float invLn10 = 0.43429448190325182765f;
+    for (int i = 0; i < n; i++) out[i] = std::log1p(in[i]) * invLn10;
+}
+
+// out = max(0, cur - prev), then prev = cur
+inline void positiveDiff(const float *__restrict cur, float *__restrict prev, float *__restrict out, int n) {
+    for (int i = 0; i < n; i++) {
+        float d = cur[i] - prev[i];
+        out[i] = d > 0.0f ? d : 0.0f;
+        prev[i] = cur[i];
+    }
+}
+
+} // namespace SpectralOps
@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+
+// Single-producer/single-consumer ring buffer for the audio path. Both ends
+// are wait-free and never allocate: the producer (audio callback) writes
+// blocks with write(), the consumer (analysis thread) takes them with read().
+// When the consumer falls behind, samples that don't fit are dropped and
+// counted rather than overwriting data the consumer may be reading.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing copies with memcpy");
+
+public:
+    explicit SpscRing(size_t capacity = 0) { reset(capacity); }
+
+    // Capacity is rounded up to a power of two. Not thread-safe; call before
+    // either side is running.
+    void reset(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buf.assign(capacity ? n : 0, T());
+        mask = capacity ? n - 1 : 0;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        overruns.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buf.size(); }
+
+    // Producer. Returns the number of items written; the rest is counted as overrun.
+    size_t write(const T *src, size_t n) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_acquire);
+        size_t count = std::min(n, buf.size() - (h - t));
+        copyIn(h, src, count);
+        head.store(h + count, std::memory_order_release);
+        if (count < n) overruns.fetch_add(n - count, std::memory_order_relaxed);
+        return count;
+    }
+
+    // Consumer. Returns the number of items read.
+    size_t read(T *dst, size_t n) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        size_t count = std::min(n, h - t);
+        copyOut(t, dst, count);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer. Drops up to n items without copying them.
+    size_t discard(size_t n) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t h = head.load(std::memory_order_acquire);
+        size_t count = std::min(n, h - t);
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    size_t readAvailable() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t writeAvailable() const { return buf.size() - readAvailable(); }
+
+    // Items dropped because the ring was full
+    uint64_t getOverrunCount() const { return overruns.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> buf;
+    size_t mask = 0;
+    // Free-running indices; their difference is the fill level
+    alignas(64) std::atomic<size_t> head{0}; // written by the producer
+    alignas(64) std::atomic<size_t> tail{0}; // written by the consumer
+    std::atomic<uint64_t> overruns{0};
+
+    void copyIn(size_t pos, const T *src, size_t n) {
+        size_t i = pos & mask;
+        size_t first = std::min(n, buf.size() - i);
+        if (first) std::memcpy(&buf[i], src, first * sizeof(T));
+        if (n > first) std::memcpy(&buf[0], src + first, (n - first) * sizeof(T));
+    }
+
+    void copyOut(size_t pos, T *dst, size_t n) const {
+        size_t i = pos & mask;
+        size_t first = std::min(n, buf.size() - i);
+        if (first) std::memcpy(dst, &buf[i], first * sizeof(T));
+        if (n > first) std::memcpy(dst + first, &buf[0], (n - first) * sizeof(T));
+    }
+};
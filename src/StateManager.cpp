@@ -8,8 +8,8 @@ void StateManager::setup(string path) {
     load();
 }
 
-void StateManager::addTrigger(int key, int stateIndex) {
-    triggers.push_back({key, stateIndex});
+void StateManager::addTrigger(int key, int stateIndex, Quantize quantize) {
+    triggers.push_back({key, stateIndex, quantize});
     save();
 }
 
@@ -20,10 +20,10 @@ void StateManager::removeTrigger(int index) {
     }
 }
 
-void StateManager::processKey(int key, WarpController &warper, Network &net) {
+void StateManager::processKey(int key, WarpController &warper, Network &net, BeatScheduler &scheduler, const Metronome &metro) {
     for(auto &t : triggers) {
         if(t.key == key) {
-            applyState(t.stateIndex, warper, net);
+            scheduleState(t.stateIndex, t.quantize, warper, net, scheduler, metro);
             break;
         }
     }
@@ -57,12 +57,49 @@ void StateManager::saveState(string name, WarpController &warper) {
 void StateManager::applyState(int index, WarpController &warper, Network &net) {
     if(index >= 0 && index < (int)states.size()) {
         currentStateIndex = index;
+        likelyDirty = true;
         string jStr = states[index].data.dump();
         warper.loadJson(jStr);
         net.sendStructure(jStr);
     }
 }
 
+void StateManager::scheduleState(int index, Quantize quantize, WarpController &warper, Network &net, BeatScheduler &scheduler, const Metronome &metro) {
+    if(index < 0 || index >= (int)states.size()) return;
+    if(quantize == QUANTIZE_NONE) {
+        applyState(index, warper, net);
+        return;
+    }
+    int64_t at = scheduler.nextBoundary(metro, quantize);
+    string jStr = states[index].data.dump();
+    net.sendStateSchedule(at, jStr);
+    scheduleStructure(at, jStr, warper, scheduler, index);
+}
+
+void StateManager::scheduleStructure(int64_t atNs, const string &jStr, WarpController &warper, BeatScheduler &scheduler, int index, bool persist) {
+    uint64_t seq = ++pendingSeq;
+    pendingData = ofJson::parse(jStr, nullptr, false);
+    likelyDirty = true;
+    auto apply = [this, &warper, jStr, index, seq, persist]() {
+        if(index >= 0) currentStateIndex = index;
+        if(seq == pendingSeq) pendingData = ofJson();
+        likelyDirty = true;
+        // Saved only once shown, so a recall dropped before its beat never
+        // reaches the disk
+        if(persist) ofBufferToFile(warper.savePath, ofBuffer(jStr.c_str(), jStr.length()));
+        warper.loadJson(jStr);
+    };
+    if(!scheduler.schedule(atNs, apply)) {
+        ofLogWarning("StateManager") << "Beat scheduler full, applying state now";
+        apply();
+    }
+}
+
+void StateManager::clearPending() {
+    pendingData = ofJson();
+    likelyDirty = true;
+}
+
 void StateManager::removeState(int index) {
     if(index >= 0 && index < (int)states.size()) {
         states.erase(states.begin() + index);
@@ -71,6 +108,7 @@ void StateManager::removeState(int index) {
 }
 
 void StateManager::save() {
+    likelyDirty = true;
     ofJson j = ofJson::array();
     for(auto &s : states) {
         j.push_back({{"name", s.name}, {"data", s.data}});
@@ -79,12 +117,13 @@ void StateManager::save() {
     
     ofJson jt = ofJson::array();
     for(auto &t : triggers) {
-        jt.push_back({{"key", t.key}, {"stateIndex", t.stateIndex}});
+        jt.push_back({{"key", t.key}, {"stateIndex", t.stateIndex}, {"quantize", (int)t.quantize}});
     }
     ofSaveJson(triggersPath, jt);
 }
 
 void StateManager::load() {
+    likelyDirty = true;
     ofFile file(configPath);
     if(file.exists()) {
         ofJson j;
@@ -107,7 +146,42 @@ void StateManager::load() {
             Trigger t;
             t.key = item.value("key", 0);
             t.stateIndex = item.value("stateIndex", 0);
+            t.quantize = (Quantize)item.value("quantize", (int)QUANTIZE_NONE);
             triggers.push_back(t);
         }
     }
 }
+
+const vector<string> &StateManager::getLikelyContent(const string &peerId) {
+    if (!likelyDirty && peerId == likelyPeer) return likelyContent;
+    likelyDirty = false;
+    likelyPeer = peerId;
+    likelyContent.clear();
+
+    // A scheduled recall is about to land; its content goes first
+    vector<const ofJson *> sources;
+    if (pendingData.is_object()) sources.push_back(&pendingData);
+
+    vector<int> candidates;
+    for (auto &t : triggers) candidates.push_back(t.stateIndex);
+    if (currentStateIndex >= 0) {
+        candidates.push_back(currentStateIndex + 1);
+        candidates.push_back(currentStateIndex - 1);
+    }
+    for (int idx : candidates) {
+        if (idx < 0 || idx >= (int)states.size() || idx == currentStateIndex) continue;
+        sources.push_back(&states[idx].data);
+    }
+
+    for (const ofJson *src : sources) {
+        const ofJson &data = *src;
+        if (!data.contains("peers") || !data["peers"].contains(peerId)) continue;
+        for (auto &surf : data["peers"][peerId]) {
+            string id = surf.value("content", "");
+            if (id.empty()) continue;
+            if (std::find(likelyContent.begin(), likelyContent.end(), id) == likelyContent.end())
+                likelyContent.push_back(id);
+        }
+    }
+    return likelyContent;
+}
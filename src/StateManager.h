@@ -1,5 +1,6 @@
 #pragma once
 #include "ofMain.h"
+#include "BeatScheduler.h"
 
 class WarpController;
 class Network;
@@ -12,6 +13,7 @@ struct State {
 struct Trigger {
     int key;
     int stateIndex;
+    Quantize quantize = QUANTIZE_NONE;
 };
 
 class StateManager {
@@ -23,12 +25,31 @@ public:
     string triggersPath;
 
     void setup(string path);
-    void addTrigger(int key, int stateIndex);
+    void addTrigger(int key, int stateIndex, Quantize quantize = QUANTIZE_NONE);
     void removeTrigger(int index);
-    void processKey(int key, WarpController &warper, Network &net);
+    void processKey(int key, WarpController &warper, Network &net, BeatScheduler &scheduler, const Metronome &metro);
     void saveState(string name, WarpController &warper);
     void applyState(int index, WarpController &warper, Network &net);
+    // Recalls a state on the next beat/bar on every peer
+    void scheduleState(int index, Quantize quantize, WarpController &warper, Network &net, BeatScheduler &scheduler, const Metronome &metro);
+    // Loads a structure at cluster time atNs; its content is preloaded meanwhile.
+    // persist also writes it to the warper's save file when it is loaded.
+    void scheduleStructure(int64_t atNs, const string &jStr, WarpController &warper, BeatScheduler &scheduler, int index = -1, bool persist = false);
+    // Forgets the pending recall, e.g. when the scheduler is cleared
+    void clearPending();
     void removeState(int index);
     void save();
     void load();
+
+    // Content ids that peerId shows in the states most likely to be recalled
+    // next: trigger targets first, then the neighbours of the current state.
+    const vector<string> &getLikelyContent(const string &peerId);
+
+private:
+    vector<string> likelyContent;
+    string likelyPeer;
+    bool likelyDirty = true;
+    // Most recently scheduled structure that hasn't been applied yet
+    ofJson pendingData;
+    uint64_t pendingSeq = 0;
 };
@@ -0,0 +1,90 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include "Metronome.h"
+#include "Timebase.h"
+
+// Steers the metronome towards the beats the tracker hears, as described in
+// beattracker.md: BPM is smoothed (old * 0.9 + new * 0.1) and each beat
+// nudges the phase by delta * 0.25, so corrections are spread over several
+// beats instead of jumping.
+//
+// Corrections only apply while the tracker is locked. Locking needs
+// engageBeats consecutive beats at or above engageConfidence; it is released
+// when confidence drops below releaseConfidence. The gap between the two
+// thresholds keeps the sync from flapping on borderline material.
+class TempoSync {
+public:
+    float bpmSmoothing = 0.9f;      // weight of the current BPM
+    float phaseGain = 0.25f;        // share of the phase error corrected per beat
+    float engageConfidence = 0.7f;
+    float releaseConfidence = 0.4f;
+    int engageBeats = 4;
+    // Consecutive downbeats that must agree before the bar is realigned
+    int downbeatVotes = 2;
+
+    bool isLocked() const { return locked; }
+    // Last phase error, in beats (positive: the music is behind the metronome)
+    double getPhaseError() const { return lastError; }
+
+    void reset() {
+        locked = false;
+        streak = 0;
+        barShift = 0;
+        barVotes = 0;
+        lastError = 0.0;
+    }
+
+    // One tracked beat at beatNs (same timebase as m.nowNs()). Returns true if
+    // the metronome was changed.
+    bool onBeat(Metronome &m, int64_t beatNs, float trackerBpm, float confidence, bool downbeat = false,
+                int trackerMeter = 0) {
+        if (locked) {
+            if (confidence < releaseConfidence) reset();
+        } else {
+            streak = confidence >= engageConfidence ? streak + 1 : 0;
+            if (streak >= engageBeats) locked = true;
+        }
+        if (!locked || trackerBpm <= 0.0f || m.bpm <= 0.0f) return false;
+
+        double pos = m.getBeatAt(beatNs);
+        double nearest = std::floor(pos + 0.5);
+        lastError = pos - nearest;
+
+        // Downbeats realign the bar once they consistently disagree with it
+        int beatsPerBar = std::max(1, m.beatsPerBar);
+        if (downbeat && trackerMeter == beatsPerBar) {
+            int inBar = (int)(((int64_t)nearest % beatsPerBar + beatsPerBar) % beatsPerBar);
+            if (inBar != 0 && inBar == barShift) {
+                barVotes++;
+            } else {
+                barShift = inBar;
+                barVotes = inBar != 0 ? 1 : 0;
+            }
+        }
+        double shift = 0.0;
+        if (barShift != 0 && barVotes >= downbeatVotes) {
+            // Move the bar start to this beat by the shortest way
+            shift = barShift <= beatsPerBar / 2 ? barShift : barShift - beatsPerBar;
+            barShift = 0;
+            barVotes = 0;
+        }
+
+        // Rebase at the bar containing this beat so a tempo change keeps the
+        // phase (and bar position) continuous, then apply the corrections.
+        // The new reference is close to now, which also keeps beat counts small.
+        double barStart = std::floor(nearest / beatsPerBar) * beatsPerBar;
+        double offset = pos - barStart - lastError * phaseGain - shift;
+        float newBpm = m.bpm * bpmSmoothing + trackerBpm * (1.0f - bpmSmoothing);
+        m.bpm = newBpm;
+        m.referenceTimeNs = beatNs - Timebase::beatsToNs(offset, newBpm);
+        return true;
+    }
+
+private:
+    bool locked = false;
+    int streak = 0;
+    int barShift = 0;
+    int barVotes = 0;
+    double lastError = 0.0;
+};
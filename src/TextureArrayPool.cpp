@@ -0,0 +1,198 @@
+#include "TextureArrayPool.h"
+
+static const char *arrayVert = R"(#version 120
+void main() {
+    gl_TexCoord[0] = gl_MultiTexCoord0;
+    gl_FrontColor = gl_Color;
+    gl_Position = gl_ModelViewProjectionMatrix * gl_Vertex;
+}
+)";
+
+static const char *arrayFrag = R"(#version 120
+#extension GL_EXT_texture_array : enable
+uniform sampler2DArray tex;
+uniform float layer;
+void main() {
+    gl_FragColor = texture2DArray(tex, vec3(gl_TexCoord[0].xy, layer)) * gl_Color;
+}
+)";
+
+TextureArrayPool &TextureArrayPool::getInstance()
+{
+    static TextureArrayPool instance;
+    return instance;
+}
+
+bool TextureArrayPool::setupShader()
+{
+    if (shader.isLoaded()) return true;
+    if (ofGetWindowPtr() == nullptr) return false;
+    shader.setupShaderFromSource(GL_VERTEX_SHADER, arrayVert);
+    shader.setupShaderFromSource(GL_FRAGMENT_SHADER, arrayFrag);
+    if (!shader.linkProgram())
+    {
+        ofLogError("TextureArrayPool") << "Failed to link texture array shader, falling back to per-clip textures";
+        maxLayerPixels = 0;
+        return false;
+    }
+    return true;
+}
+
+bool TextureArrayPool::accepts(int w, int h)
+{
+    if (w <= 0 || h <= 0 || w * h > maxLayerPixels) return false;
+    return setupShader();
+}
+
+TextureArrayPool::Array *TextureArrayPool::createArray(int w, int h)
+{
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    int layers = std::max(1, std::min(layersPerArray, (int)maxLayers));
+
+    auto arr = make_unique<Array>();
+    arr->width = w;
+    arr->height = h;
+    glGenTextures(1, &arr->texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, arr->texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB8, w, h, layers, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    boundTexture = 0;
+
+    arr->fbos.resize(layers, 0);
+    arr->used.resize(layers, false);
+    glGenFramebuffers(layers, arr->fbos.data());
+
+    GLint prevFbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    for (int i = 0; i < layers; i++)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, arr->fbos[i]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, arr->texture, 0, i);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+
+    ofLogNotice("TextureArrayPool") << "Allocated " << w << "x" << h << " array with " << layers << " layers";
+    arrays.push_back(std::move(arr));
+    return arrays.back().get();
+}
+
+TextureLayer TextureArrayPool::acquire(int w, int h)
+{
+    TextureLayer out;
+    if (!accepts(w, h)) return out;
+
+    Array *target = nullptr;
+    int slot = -1;
+    for (auto &arr : arrays)
+    {
+        if (arr->width != w || arr->height != h) continue;
+        for (size_t i = 0; i < arr->used.size(); i++)
+        {
+            if (!arr->used[i]) { target = arr.get(); slot = (int)i; break; }
+        }
+        if (target) break;
+    }
+    if (!target)
+    {
+        target = createArray(w, h);
+        slot = 0;
+    }
+
+    target->used[slot] = true;
+    out.texture = target->texture;
+    out.fbo = target->fbos[slot];
+    out.layer = slot;
+    out.width = w;
+    out.height = h;
+    return out;
+}
+
+void TextureArrayPool::release(const TextureLayer &layer)
+{
+    if (!layer.isValid()) return;
+    for (auto &arr : arrays)
+    {
+        if (arr->texture == layer.texture && layer.layer < (int)arr->used.size())
+        {
+            arr->used[layer.layer] = false;
+            return;
+        }
+    }
+}
+
+void TextureArrayPool::trim()
+{
+    for (auto it = arrays.begin(); it != arrays.end();)
+    {
+        Array &arr = **it;
+        if (std::none_of(arr.used.begin(), arr.used.end(), [](bool u) { return u; }))
+        {
+            if (boundTexture == arr.texture) unbind();
+            glDeleteFramebuffers((GLsizei)arr.fbos.size(), arr.fbos.data());
+            glDeleteTextures(1, &arr.texture);
+            it = arrays.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void TextureArrayPool::bind(const TextureLayer &layer)
+{
+    if (!layer.isValid() || !setupShader()) return;
+    if (!shaderActive)
+    {
+        shader.begin();
+        shader.setUniform1i("tex", 0);
+        shaderActive = true;
+    }
+    if (boundTexture != layer.texture)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, layer.texture);
+        boundTexture = layer.texture;
+    }
+    shader.setUniform1f("layer", (float)layer.layer);
+}
+
+void TextureArrayPool::unbind()
+{
+    if (boundTexture)
+    {
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        boundTexture = 0;
+    }
+    if (shaderActive)
+    {
+        shader.end();
+        shaderActive = false;
+    }
+}
+
+void TextureArrayPool::draw(const TextureLayer &layer, float x, float y, float w, float h)
+{
+    if (!layer.isValid()) return;
+    ofMesh quad;
+    quad.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+    quad.addVertex(glm::vec3(x, y, 0));     quad.addTexCoord(glm::vec2(0, 0));
+    quad.addVertex(glm::vec3(x + w, y, 0)); quad.addTexCoord(glm::vec2(1, 0));
+    quad.addVertex(glm::vec3(x + w, y + h, 0)); quad.addTexCoord(glm::vec2(1, 1));
+    quad.addVertex(glm::vec3(x, y + h, 0)); quad.addTexCoord(glm::vec2(0, 1));
+    bind(layer);
+    quad.draw();
+    unbind();
+}
+
+size_t TextureArrayPool::getAllocatedBytes()
+{
+    size_t total = 0;
+    for (auto &arr : arrays)
+        total += (size_t)arr->width * arr->height * 3 * arr->used.size();
+    return total;
+}
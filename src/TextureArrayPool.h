@@ -0,0 +1,62 @@
+#pragma once
+#include "ofMain.h"
+#include <memory>
+#include <vector>
+
+// One slice of a shared GL_TEXTURE_2D_ARRAY, with an FBO that renders into it.
+struct TextureLayer {
+    GLuint texture = 0;
+    GLuint fbo = 0;
+    int layer = -1;
+    int width = 0;
+    int height = 0;
+
+    bool isValid() const { return texture != 0 && layer >= 0; }
+};
+
+// Pool of 2D array textures for small clips. Clips of the same size share one
+// array and are drawn with a single texture bind, instead of each owning a
+// separately allocated FBO texture.
+class TextureArrayPool
+{
+public:
+    TextureArrayPool(const TextureArrayPool &) = delete;
+    void operator=(const TextureArrayPool &) = delete;
+    static TextureArrayPool &getInstance();
+
+    int maxLayerPixels = 1280 * 720;
+    int layersPerArray = 8;
+
+    bool accepts(int w, int h);
+    TextureLayer acquire(int w, int h);
+    void release(const TextureLayer &layer);
+    // Frees arrays with no layers in use
+    void trim();
+
+    // Binds the array shader and texture; consecutive draws from the same array skip the rebind.
+    void bind(const TextureLayer &layer);
+    void unbind();
+    void draw(const TextureLayer &layer, float x, float y, float w, float h);
+
+    size_t getAllocatedBytes();
+    int getArrayCount() { return (int)arrays.size(); }
+
+private:
+    TextureArrayPool() {}
+
+    struct Array {
+        GLuint texture = 0;
+        int width = 0;
+        int height = 0;
+        vector<GLuint> fbos;
+        vector<bool> used;
+    };
+
+    vector<unique_ptr<Array>> arrays;
+    ofShader shader;
+    GLuint boundTexture = 0;
+    bool shaderActive = false;
+
+    bool setupShader();
+    Array *createArray(int w, int h);
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+// Monotonic 64-bit nanosecond time shared by the metronome, the beat tracker
+// and the network protocol. steady_clock never jumps with wall-clock changes,
+// and int64 ns covers ~292 years, so timestamps stay exact over weeks of
+// uptime. Differences are always taken in integers before converting to
+// floating point; a double holding an absolute time would lose sub-µs
+// precision after a few months.
+namespace Timebase {
+
+constexpr int64_t NS_PER_MS = 1000000;
+constexpr int64_t NS_PER_SEC = 1000000000;
+constexpr int64_t NS_PER_MIN = 60 * NS_PER_SEC;
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline double toSeconds(int64_t ns) { return (double)ns / NS_PER_SEC; }
+inline double toMillis(int64_t ns) { return (double)ns / NS_PER_MS; }
+inline int64_t fromSeconds(double s) { return (int64_t)(s * NS_PER_SEC); }
+inline int64_t fromMillis(double ms) { return (int64_t)(ms * NS_PER_MS); }
+
+// Beats elapsed between two timestamps. Whole minutes are split off in
+// integers so the fractional part keeps full precision at any distance.
+inline double beatsBetween(int64_t fromNs, int64_t toNs, double bpm) {
+    int64_t elapsed = toNs - fromNs;
+    int64_t minutes = elapsed / NS_PER_MIN;
+    int64_t rest = elapsed % NS_PER_MIN;
+    return minutes * bpm + (double)rest * bpm / NS_PER_MIN;
+}
+
+// Inverse of beatsBetween: duration of `beats` at `bpm`
+inline int64_t beatsToNs(double beats, double bpm) {
+    return (int64_t)std::llround(beats * NS_PER_MIN / bpm);
+}
+
+} // namespace Timebase
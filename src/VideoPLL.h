@@ -0,0 +1,124 @@
+#pragma once
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+// Musical layout of one loop of a clip. Skewer exports every segment as a
+// multiple of 0.5s, so without a sidecar a clip is assumed to run at 120 BPM.
+struct ClipBeatMap {
+    double beats = 0;  // beats in one loop; <= 0 means "derive from duration"
+    double anchor = 0; // clip time (s) where beat 0 sits
+
+    double beatsFor(double duration) const {
+        if (beats > 0) return beats;
+        return std::max(1.0, std::round(duration * 2.0));
+    }
+};
+
+// Phase-locked loop that steers playback speed so a looping clip's beat
+// phase follows the metronome. The phase error (in beats) is smoothed to
+// reject frame-quantized position jitter, then fed to a PI controller around
+// the clip's natural-to-target tempo ratio. Errors too large to slew out are
+// fixed with a hard seek instead.
+class VideoPLL {
+public:
+    double kp = 0.8;                 // relative speed change per beat of error
+    double ki = 0.2;                 // integral gain, per beat-second
+    double maxSkew = 0.15;           // clamp on the relative correction
+    double jitterAlpha = 0.25;       // EMA weight of each new error sample
+    double seekThresholdBeats = 1.0; // beyond this, seek instead of slewing
+    double seekLeadSeconds = 0.05;   // aim the seek slightly ahead to cover its latency
+    size_t historySize = 256;
+
+    struct Output {
+        double speed = 1.0;
+        bool seek = false;
+        double seekTime = 0; // clip seconds
+    };
+
+    // clipTime/duration in clip seconds, metroBeat in beats, dt in seconds
+    Output update(double clipTime, double duration, double metroBeat, double bpm, double dt, const ClipBeatMap &map) {
+        Output out;
+        if (duration <= 0 || bpm <= 0) return out;
+        double B = map.beatsFor(duration);
+        double beatsPerSecond = B / duration;
+        out.speed = (bpm / 60.0) / beatsPerSecond;
+
+        double clipBeat = wrap((clipTime - map.anchor) * beatsPerSecond, B);
+        double targetBeat = wrap(metroBeat, B);
+        double e = targetBeat - clipBeat;
+        if (e > B * 0.5) e -= B;
+        if (e < -B * 0.5) e += B;
+        rawError = e;
+
+        if (std::abs(e) > seekThresholdBeats) {
+            out.seek = true;
+            double lead = seekLeadSeconds * (bpm / 60.0);
+            out.seekTime = wrap((targetBeat + lead) / beatsPerSecond + map.anchor, duration);
+            seeks++;
+            integral = 0;
+            filtered = 0;
+            record(e);
+            return out;
+        }
+
+        filtered += jitterAlpha * (e - filtered);
+        integral = clamp(integral + ki * filtered * dt, maxSkew);
+        double correction = clamp(kp * filtered + integral, maxSkew);
+        out.speed *= 1.0 + correction;
+        record(e);
+        return out;
+    }
+
+    void reset() {
+        filtered = integral = rawError = 0;
+        sumSq = 0;
+        maxAbs = 0;
+        samples = 0;
+        seeks = 0;
+        history.clear();
+        historyPos = 0;
+    }
+
+    double getPhaseError() const { return filtered; }
+    double getRawPhaseError() const { return rawError; }
+    double getRmsError() const { return samples ? std::sqrt(sumSq / samples) : 0.0; }
+    double getMaxError() const { return maxAbs; }
+    int getSeekCount() const { return seeks; }
+    // Raw error per update, oldest first
+    std::vector<float> getHistory() const {
+        std::vector<float> out(history.begin() + historyPos, history.end());
+        out.insert(out.end(), history.begin(), history.begin() + historyPos);
+        return out;
+    }
+
+private:
+    double filtered = 0;
+    double integral = 0;
+    double rawError = 0;
+    double sumSq = 0;
+    double maxAbs = 0;
+    long samples = 0;
+    int seeks = 0;
+    std::vector<float> history;
+    size_t historyPos = 0;
+
+    static double wrap(double v, double m) {
+        double r = std::fmod(v, m);
+        return r < 0 ? r + m : r;
+    }
+
+    static double clamp(double v, double lim) { return std::max(-lim, std::min(lim, v)); }
+
+    void record(double e) {
+        sumSq += e * e;
+        maxAbs = std::max(maxAbs, std::abs(e));
+        samples++;
+        if (history.size() < historySize) {
+            history.push_back((float)e);
+        } else {
+            history[historyPos] = (float)e;
+            historyPos = (historyPos + 1) % history.size();
+        }
+    }
+};
@@ -51,39 +51,85 @@ void WarpController::update() { contents.update(); }
 void WarpController::draw()
 {
     vector<shared_ptr<WarpSurface>> subset = getSurfacesForPeer(targetPeerId);
+    auto &pool = TextureArrayPool::getInstance();
 
+    // Consecutive surfaces whose clips live in the same texture array share one bind
     for (size_t i = 0; i < subset.size(); i++)
     {
+        TextureLayer layer;
+        if (contents.getLayerById(subset[i]->contentId, layer))
+        {
+            subset[i]->drawLayer(layer, ofGetWidth(), ofGetHeight());
+            continue;
+        }
+        pool.unbind();
         ofTexture &tex = contents.getTextureById(subset[i]->contentId);
         subset[i]->draw(tex, ofGetWidth(), ofGetHeight());
     }
+    pool.unbind();
 }
 
 void WarpController::drawDebug()
 {
     vector<shared_ptr<WarpSurface>> subset = getSurfacesForPeer(targetPeerId);
+    auto &pool = TextureArrayPool::getInstance();
     for (size_t i = 0; i < subset.size(); i++)
     {
-        ofTexture &tex = contents.getTextureById(subset[i]->contentId);
+        TextureLayer layer;
+        bool hasLayer = contents.getLayerById(subset[i]->contentId, layer);
+        ofTexture *tex = nullptr;
+        if (!hasLayer)
+        {
+            pool.unbind();
+            tex = &contents.getTextureById(subset[i]->contentId);
+        }
+
         if (editMode == EDIT_TEXTURE)
         {
             if (selectedIndex == i)
             {
                 ofSetColor(255);
-                tex.draw(0, 0, ofGetWidth(), ofGetHeight());
+                if (hasLayer) pool.draw(layer, 0, 0, ofGetWidth(), ofGetHeight());
+                else tex->draw(0, 0, ofGetWidth(), ofGetHeight());
             }
         }
         else if (editMode == EDIT_MAPPING)
         {
             bool faded = selectedIndex != i;
-            subset[i]->draw(tex, ofGetWidth(), ofGetHeight(), faded);
+            if (hasLayer) subset[i]->drawLayer(layer, ofGetWidth(), ofGetHeight(), faded);
+            else subset[i]->draw(*tex, ofGetWidth(), ofGetHeight(), faded);
         }
     }
+    pool.unbind();
 
     if (editMode != EDIT_NONE && selectedIndex >= 0 && selectedIndex < (int)subset.size())
     {
         subset[selectedIndex]->drawDebug(ofGetWidth(), ofGetHeight(), editMode);
     }
+
+    if (selecting && selectPath.size() >= 2)
+    {
+        ofPushStyle();
+        ofNoFill();
+        ofSetColor(ofColor::magenta);
+        ofPolyline outline;
+        if (lassoSelecting)
+        {
+            for (auto &p : selectPath) outline.addVertex(p.x * ofGetWidth(), p.y * ofGetHeight());
+        }
+        else
+        {
+            glm::vec2 a = selectPath[0] * glm::vec2(ofGetWidth(), ofGetHeight());
+            glm::vec2 b = selectPath[1] * glm::vec2(ofGetWidth(), ofGetHeight());
+            outline.addVertex(a.x, a.y);
+            outline.addVertex(b.x, a.y);
+            outline.addVertex(b.x, b.y);
+            outline.addVertex(a.x, b.y);
+        }
+        outline.close();
+        outline.draw();
+        ofPopStyle();
+    }
 }
 
 void WarpController::resizeSurface(string peerId, int surfIdx, int dRow, int dCol, Network &net)
@@ -209,17 +255,40 @@ void WarpController::mousePressed(int x, int y, Network &net)
     if (selectedIndex >= 0 && selectedIndex < (int)subset.size())
     {
         auto s = subset[selectedIndex];
+        float w = ofGetWidth(), h = ofGetHeight();
 
-        int hit = s->getHit(x, y, ofGetWidth(), ofGetHeight(), editMode);
-        if (hit != -1)
+        int hit = s->getHit(x, y, w, h, editMode);
+        if (ofGetKeyPressed(OF_KEY_CONTROL))
+        {
+            if (hit != -1)
+            {
+                s->toggleSelected(hit, editMode);
+            }
+            else
+            {
+                selecting = true;
+                lassoSelecting = ofGetKeyPressed(OF_KEY_SHIFT);
+                selectPath.assign(1, glm::vec2(x / w, y / h));
+            }
+        }
+        else if (hit != -1 && s->isSelected(hit, editMode))
         {
+            s->selectedPoint = -3;
+        }
+        else if (hit != -1)
+        {
+            s->clearSelection();
             s->selectedPoint = hit;
         }
         else if ((ofGetKeyPressed(OF_KEY_SHIFT) || ofGetKeyPressed(OF_KEY_ALT)) &&
-                 s->contains(x, y, ofGetWidth(), ofGetHeight(), editMode))
+                 s->contains(x, y, w, h, editMode))
         {
             s->selectedPoint = -2;
         }
+        else
+        {
+            s->clearSelection();
+        }
     }
 }
 
@@ -232,11 +301,45 @@ void WarpController::mouseDragged(int x, int y, Network &net)
     if (selectedIndex >= 0 && selectedIndex < (int)subset.size())
     {
         auto s = subset[selectedIndex];
+        float w = ofGetWidth(), h = ofGetHeight();
 
-        if (s->selectedPoint != -1)
+        if (selecting)
+        {
+            glm::vec2 p(ofClamp(x / w, 0, 1), ofClamp(y / h, 0, 1));
+            if (!lassoSelecting) selectPath.resize(1);
+            if (!lassoSelecting || glm::distance(p * glm::vec2(w, h), selectPath.back() * glm::vec2(w, h)) > 4)
+                selectPath.push_back(p);
+        }
+        else if (s->selectedPoint == -3 && s->hasSelection(editMode))
+        {
+            // Whole selection moves as one edit: one mesh update, one packet
+            float dx = (x - lastMouse.x) / w;
+            float dy = (y - lastMouse.y) / h;
+            glm::vec2 pivot = s->getSelectionCentroid(editMode);
+
+            if (ofGetKeyPressed(OF_KEY_ALT))
+            {
+                float scaleFactor = 1.0f + (dx + dy);
+                s->transformPoints(s->selection, SEL_SCALE, scaleFactor, 0, pivot, editMode);
+                net.sendWarpSelection(s->ownerId, selectedIndex, editMode, SEL_SCALE, scaleFactor, 0, pivot, s->selection);
+            }
+            else if (ofGetKeyPressed(OF_KEY_SHIFT))
+            {
+                glm::vec2 pivotPx = pivot * glm::vec2(w, h);
+                float angle = atan2(y - pivotPx.y, x - pivotPx.x) - atan2(lastMouse.y - pivotPx.y, lastMouse.x - pivotPx.x);
+                s->transformPoints(s->selection, SEL_ROTATE, angle, w / h, pivot, editMode);
+                net.sendWarpSelection(s->ownerId, selectedIndex, editMode, SEL_ROTATE, angle, w / h, pivot, s->selection);
+            }
+            else
+            {
+                s->transformPoints(s->selection, SEL_TRANSLATE, dx, dy, pivot, editMode);
+                net.sendWarpSelection(s->ownerId, selectedIndex, editMode, SEL_TRANSLATE, dx, dy, pivot, s->selection);
+            }
+        }
+        else if (s->selectedPoint != -1)
         {
-            float dx = (x - lastMouse.x) / (float)ofGetWidth();
-            float dy = (y - lastMouse.y) / (float)ofGetHeight();
+            float dx = (x - lastMouse.x) / w;
+            float dy = (y - lastMouse.y) / h;
 
             if (ofGetKeyPressed(OF_KEY_SHIFT))
             {
@@ -245,13 +348,7 @@ void WarpController::mouseDragged(int x, int y, Network &net)
             }
             else if (ofGetKeyPressed(OF_KEY_ALT))
             {
-                auto &verts = (editMode == EDIT_TEXTURE) ? s->sourceMesh.getVertices() : s->renderMesh.getVertices();
-                glm::vec2 centroid(0, 0);
-                for (auto &v : verts)
-                    centroid += glm::vec2(v.x, v.y);
-                if (!verts.empty())
-                    centroid /= (float)verts.size();
-
+                glm::vec2 centroid = s->getCentroid(editMode);
                 float scaleFactor = 1.0f + (dx + dy);
                 s->scaleAll(scaleFactor, centroid, editMode);
                 net.sendWarpScaleAll(s->ownerId, selectedIndex, editMode, scaleFactor, centroid.x, centroid.y);
@@ -276,12 +373,22 @@ void WarpController::mouseReleased(Network &net)
     vector<shared_ptr<WarpSurface>> subset = getSurfacesForPeer(targetPeerId);
     if (selectedIndex >= 0 && selectedIndex < (int)subset.size())
     {
-        if (subset[selectedIndex]->selectedPoint != -1)
+        if (selecting)
+        {
+            auto s = subset[selectedIndex];
+            if (lassoSelecting)
+                s->selectLasso(selectPath, editMode);
+            else if (selectPath.size() == 2)
+                s->selectRect(selectPath[0].x, selectPath[0].y, selectPath[1].x, selectPath[1].y, editMode);
+        }
+        else if (subset[selectedIndex]->selectedPoint != -1)
         {
             subset[selectedIndex]->selectedPoint = -1;
             sync(net);
         }
     }
+    selecting = false;
+    selectPath.clear();
 }
 
 void WarpController::sync(Network &net)
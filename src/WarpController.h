@@ -15,6 +15,11 @@ public:
     int selectedIndex = 0;
     int editMode = EDIT_MAPPING;
     glm::vec2 lastMouse;
+
+    // Ctrl-drag box (Ctrl+Shift for lasso) selection in progress, normalized coords
+    bool selecting = false;
+    bool lassoSelecting = false;
+    vector<glm::vec2> selectPath;
     string savePath;
     string mediaPath;
     string myPeerId;
@@ -29,6 +29,8 @@ void WarpSurface::setup(int r, int c)
             controlSource[idx] = glm::vec3(px, py, 0);
         }
     }
+    clearSelection();
+    rebuildIndex();
     rebuildMeshTopology();
 }
 
@@ -70,6 +72,8 @@ void WarpSurface::setGridSize(int newRows, int newCols)
     controlRender = newRender;
     controlSource = newSource;
     selectedPoint = -1;
+    clearSelection();
+    rebuildIndex();
     rebuildMeshTopology();
 }
 
@@ -109,6 +113,12 @@ void WarpSurface::rebuildMeshTopology()
 
 void WarpSurface::requestMeshUpdate() { meshDirty = true; }
 
+void WarpSurface::rebuildIndex()
+{
+    renderIndex.rebuild(controlRender);
+    sourceIndex.rebuild(controlSource);
+}
+
 void WarpSurface::updateMeshPositions()
 {
     calculateSplineSurface(controlRender, renderMesh.getVertices(), rows, cols, resolution);
@@ -212,6 +222,22 @@ void WarpSurface::draw(ofTexture &tex, float w, float h, bool faded)
     ofPopMatrix();
 }
 
+void WarpSurface::drawLayer(const TextureLayer &layer, float w, float h, bool faded)
+{
+    if (meshDirty && (ofGetElapsedTimef() - lastMeshUpdate > updateInterval)) updateMeshPositions();
+    renderMesh.clearTexCoords();
+    const auto &srcVerts = sourceMesh.getVertices();
+    if (renderMesh.getTexCoords().capacity() < srcVerts.size()) renderMesh.getTexCoords().reserve(srcVerts.size());
+    for (const auto &v : srcVerts) renderMesh.addTexCoord(glm::vec2(v.x, v.y));
+    ofPushMatrix();
+    ofScale(w, h, 1);
+    if (faded) ofSetColor(255, 100);
+    else ofSetColor(255);
+    TextureArrayPool::getInstance().bind(layer);
+    renderMesh.draw();
+    ofPopMatrix();
+}
+
 void WarpSurface::drawDebug(float w, float h, int mode)
 {
     if (mode == EDIT_NONE) return;
@@ -235,8 +261,9 @@ void WarpSurface::drawDebug(float w, float h, int mode)
     }
     for (size_t i = 0; i < verts.size(); i++)
     {
-        ofSetColor((int)i == selectedPoint ? ofColor::yellow : ofColor::cyan);
-        ofDrawCircle(verts[i], (int)i == selectedPoint ? 0.015 : 0.01);
+        bool picked = (int)i == selectedPoint || isSelected(i, mode);
+        ofSetColor((int)i == selectedPoint ? ofColor::yellow : (picked ? ofColor::magenta : ofColor::cyan));
+        ofDrawCircle(verts[i], picked ? 0.015 : 0.01);
     }
     ofPopMatrix();
     ofPopStyle();
@@ -248,24 +275,20 @@ string WarpSurface::getContentId() { return contentId; }
 int WarpSurface::getHit(float x, float y, float w, float h, int mode)
 {
     if (mode == EDIT_NONE) return -1;
-    auto &verts = (mode == EDIT_TEXTURE) ? controlSource : controlRender;
-    float minD = 30;
-    int hit = -1;
-    for (size_t i = 0; i < verts.size(); i++)
-    {
-        float d = ofDist(x, y, verts[i].x * w, verts[i].y * h);
-        if (d < minD) { minD = d; hit = (int)i; }
-    }
-    return hit;
+    if (mode == EDIT_TEXTURE) return sourceIndex.nearest(controlSource, x, y, w, h, 30);
+    return renderIndex.nearest(controlRender, x, y, w, h, 30);
 }
 
 void WarpSurface::updatePoint(int idx, float x, float y, int mode)
 {
     if (mode == EDIT_NONE) return;
     auto *target = (mode == EDIT_TEXTURE) ? &controlSource : &controlRender;
+    auto &index = (mode == EDIT_TEXTURE) ? sourceIndex : renderIndex;
     if (target && idx >= 0 && idx < (int)target->size())
     {
+        glm::vec3 old = (*target)[idx];
         (*target)[idx] = glm::vec3(x, y, 0);
+        index.update(*target, idx, old.x, old.y);
         requestMeshUpdate();
     }
 }
@@ -273,18 +296,9 @@ void WarpSurface::updatePoint(int idx, float x, float y, int mode)
 bool WarpSurface::contains(float x, float y, float w, float h, int mode)
 {
     if (mode == EDIT_NONE) return false;
-    auto &verts = (mode == EDIT_TEXTURE) ? controlSource : controlRender;
-    if (verts.empty()) return false;
-    float minX = verts[0].x, maxX = verts[0].x, minY = verts[0].y, maxY = verts[0].y;
-    for (auto &v : verts)
-    {
-        if (v.x < minX) minX = v.x;
-        if (v.x > maxX) maxX = v.x;
-        if (v.y < minY) minY = v.y;
-        if (v.y > maxY) maxY = v.y;
-    }
     float nx = x / w, ny = y / h;
-    return (nx >= minX && nx <= maxX && ny >= minY && ny <= maxY);
+    if (mode == EDIT_TEXTURE) return sourceIndex.contains(controlSource, nx, ny);
+    return renderIndex.contains(controlRender, nx, ny);
 }
 
 void WarpSurface::moveAll(float dx, float dy, int mode)
@@ -296,6 +310,7 @@ void WarpSurface::moveAll(float dx, float dy, int mode)
         v.x = ofClamp(v.x + dx, 0.0f, 1.0f);
         v.y = ofClamp(v.y + dy, 0.0f, 1.0f);
     }
+    ((mode == EDIT_TEXTURE) ? sourceIndex : renderIndex).rebuild(*verts);
     requestMeshUpdate();
 }
 
@@ -311,6 +326,134 @@ void WarpSurface::scaleAll(float scaleFactor, glm::vec2 centroid, int mode)
         v.x = ofClamp(newPos.x, 0.0f, 1.0f);
         v.y = ofClamp(newPos.y, 0.0f, 1.0f);
     }
+    ((mode == EDIT_TEXTURE) ? sourceIndex : renderIndex).rebuild(*verts);
+    requestMeshUpdate();
+}
+
+glm::vec2 WarpSurface::getCentroid(int mode)
+{
+    float cx, cy;
+    if (mode == EDIT_TEXTURE) sourceIndex.getCentroid(cx, cy);
+    else renderIndex.getCentroid(cx, cy);
+    return glm::vec2(cx, cy);
+}
+
+void WarpSurface::clearSelection()
+{
+    selection.clear();
+    selectionMode = EDIT_NONE;
+}
+
+void WarpSurface::selectRect(float x0, float y0, float x1, float y1, int mode, bool additive)
+{
+    if (mode == EDIT_NONE) return;
+    if (!additive || selectionMode != mode) selection.clear();
+    selectionMode = mode;
+    vector<int> found;
+    if (mode == EDIT_TEXTURE) sourceIndex.queryRect(controlSource, x0, y0, x1, y1, found);
+    else renderIndex.queryRect(controlRender, x0, y0, x1, y1, found);
+    vector<int> merged;
+    std::set_union(selection.begin(), selection.end(), found.begin(), found.end(), std::back_inserter(merged));
+    selection.swap(merged);
+}
+
+void WarpSurface::selectLasso(const vector<glm::vec2> &poly, int mode, bool additive)
+{
+    if (mode == EDIT_NONE || poly.size() < 3) return;
+    if (!additive || selectionMode != mode) selection.clear();
+    selectionMode = mode;
+
+    // Narrow down with the polygon's bounding box, then do the even-odd test
+    float x0 = poly[0].x, x1 = poly[0].x, y0 = poly[0].y, y1 = poly[0].y;
+    for (auto &p : poly)
+    {
+        x0 = std::min(x0, p.x); x1 = std::max(x1, p.x);
+        y0 = std::min(y0, p.y); y1 = std::max(y1, p.y);
+    }
+    auto &verts = (mode == EDIT_TEXTURE) ? controlSource : controlRender;
+    vector<int> candidates;
+    if (mode == EDIT_TEXTURE) sourceIndex.queryRect(controlSource, x0, y0, x1, y1, candidates);
+    else renderIndex.queryRect(controlRender, x0, y0, x1, y1, candidates);
+
+    vector<int> found;
+    for (int idx : candidates)
+    {
+        const glm::vec3 &v = verts[idx];
+        bool inside = false;
+        for (size_t i = 0, j = poly.size() - 1; i < poly.size(); j = i++)
+        {
+            if (((poly[i].y > v.y) != (poly[j].y > v.y)) &&
+                (v.x < (poly[j].x - poly[i].x) * (v.y - poly[i].y) / (poly[j].y - poly[i].y) + poly[i].x))
+                inside = !inside;
+        }
+        if (inside) found.push_back(idx);
+    }
+    vector<int> merged;
+    std::set_union(selection.begin(), selection.end(), found.begin(), found.end(), std::back_inserter(merged));
+    selection.swap(merged);
+}
+
+void WarpSurface::toggleSelected(int idx, int mode)
+{
+    if (mode == EDIT_NONE || idx < 0) return;
+    if (selectionMode != mode) selection.clear();
+    selectionMode = mode;
+    auto it = std::lower_bound(selection.begin(), selection.end(), idx);
+    if (it != selection.end() && *it == idx) selection.erase(it);
+    else selection.insert(it, idx);
+}
+
+bool WarpSurface::isSelected(int idx, int mode)
+{
+    return selectionMode == mode && std::binary_search(selection.begin(), selection.end(), idx);
+}
+
+glm::vec2 WarpSurface::getSelectionCentroid(int mode)
+{
+    glm::vec2 c(0, 0);
+    if (!hasSelection(mode)) return c;
+    auto &verts = (mode == EDIT_TEXTURE) ? controlSource : controlRender;
+    for (int idx : selection)
+        if (idx < (int)verts.size()) c += glm::vec2(verts[idx].x, verts[idx].y);
+    return c / (float)selection.size();
+}
+
+void WarpSurface::transformPoints(const vector<int> &indices, int op, float a, float b, glm::vec2 pivot, int mode)
+{
+    if (mode == EDIT_NONE || indices.empty()) return;
+    auto &verts = (mode == EDIT_TEXTURE) ? controlSource : controlRender;
+    auto &index = (mode == EDIT_TEXTURE) ? sourceIndex : renderIndex;
+    float cosA = cos(a), sinA = sin(a);
+    float aspect = (b > 0) ? b : 1.0f;
+    // Moving most of the net costs the same as a rebuild, so skip per-point bookkeeping
+    bool bulk = indices.size() * 4 > verts.size();
+
+    for (int idx : indices)
+    {
+        if (idx < 0 || idx >= (int)verts.size()) continue;
+        glm::vec3 &v = verts[idx];
+        glm::vec3 old = v;
+        glm::vec2 p(v.x, v.y);
+        if (op == SEL_TRANSLATE)
+        {
+            p += glm::vec2(a, b);
+        }
+        else if (op == SEL_SCALE)
+        {
+            p = pivot + (p - pivot) * a;
+        }
+        else if (op == SEL_ROTATE)
+        {
+            // Rotate in viewport pixels so the shape doesn't shear on non-square outputs
+            glm::vec2 d = p - pivot;
+            d.x *= aspect;
+            p = pivot + glm::vec2((d.x * cosA - d.y * sinA) / aspect, d.x * sinA + d.y * cosA);
+        }
+        v.x = ofClamp(p.x, 0.0f, 1.0f);
+        v.y = ofClamp(p.y, 0.0f, 1.0f);
+        if (!bulk) index.update(verts, idx, old.x, old.y);
+    }
+    if (bulk) index.rebuild(verts);
     requestMeshUpdate();
 }
 
@@ -345,5 +488,6 @@ void WarpSurface::fromJson(ofJson j)
         for (size_t i = 0; i < j["tex"].size() && i < controlSource.size(); i++)
             controlSource[i] = glm::vec3(j["tex"][i]["x"], j["tex"][i]["y"], 0);
     }
+    rebuildIndex();
     rebuildMeshTopology();
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include "ofMain.h"
 #include "PacketDef.h"
+#include "ControlPointIndex.h"
+#include "TextureArrayPool.h"
 #include <algorithm>
 
 class WarpSurface
@@ -22,6 +24,10 @@ public:
 
     int selectedPoint = -1;
 
+    // Multi-point selection (sorted indices into the control net of selectionMode)
+    vector<int> selection;
+    int selectionMode = EDIT_NONE;
+
     float lastMeshUpdate = 0.0f;
     bool meshDirty = true;
     float updateInterval = 0.1f;
@@ -39,6 +45,8 @@ public:
     void calculateSplineSurface(const vector<glm::vec3> &ctrls, vector<glm::vec3> &targetVerts, int cRows, int cCols, int res);
 
     void draw(ofTexture &tex, float w, float h, bool faded = false);
+    // Draws from a texture array layer; leaves the array bound for the next surface
+    void drawLayer(const TextureLayer &layer, float w, float h, bool faded = false);
     void drawDebug(float w, float h, int mode);
 
     void setContentId(string id);
@@ -49,7 +57,23 @@ public:
     bool contains(float x, float y, float w, float h, int mode);
     void moveAll(float dx, float dy, int mode);
     void scaleAll(float scaleFactor, glm::vec2 centroid, int mode);
+    glm::vec2 getCentroid(int mode);
+
+    void clearSelection();
+    void selectRect(float x0, float y0, float x1, float y1, int mode, bool additive = false);
+    void selectLasso(const vector<glm::vec2> &poly, int mode, bool additive = false);
+    void toggleSelected(int idx, int mode);
+    bool isSelected(int idx, int mode);
+    bool hasSelection(int mode) { return selectionMode == mode && !selection.empty(); }
+    glm::vec2 getSelectionCentroid(int mode);
+    void transformPoints(const vector<int> &indices, int op, float a, float b, glm::vec2 pivot, int mode);
 
     ofJson toJson();
     void fromJson(ofJson j);
+
+private:
+    ControlPointIndex renderIndex;
+    ControlPointIndex sourceIndex;
+
+    void rebuildIndex();
 };
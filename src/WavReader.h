@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Minimal RIFF/WAVE reader for offline analysis: 16/24/32-bit PCM and 32-bit
+// float (including WAVE_FORMAT_EXTENSIBLE), returned as interleaved floats
+// in [-1, 1].
+struct WavData {
+    int sampleRate = 0;
+    int channels = 0;
+    std::vector<float> samples; // interleaved
+
+    size_t getNumFrames() const { return channels ? samples.size() / channels : 0; }
+    double getDuration() const { return sampleRate ? (double)getNumFrames() / sampleRate : 0.0; }
+};
+
+namespace WavReader {
+
+inline uint32_t le32(const unsigned char *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+inline uint16_t le16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+// Returns false and fills error on failure
+inline bool load(const std::string &path, WavData &out, std::string &error) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if (data.size() < 12 || std::memcmp(data.data(), "RIFF", 4) != 0 || std::memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    int format = 0, bits = 0;
+    const unsigned char *pcm = nullptr;
+    size_t pcmBytes = 0;
+    size_t pos = 12;
+    while (pos + 8 <= data.size()) {
+        const unsigned char *chunk = data.data() + pos;
+        size_t size = le32(chunk + 4);
+        size_t avail = std::min(size, data.size() - pos - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && avail >= 16) {
+            format = le16(chunk + 8);
+            out.channels = le16(chunk + 10);
+            out.sampleRate = (int)le32(chunk + 12);
+            bits = le16(chunk + 22);
+            if (format == 0xFFFE && avail >= 26) format = le16(chunk + 32); // extensible: sub-format GUID
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            pcm = chunk + 8;
+            pcmBytes = avail; // tolerate truncated files
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    if (!pcm || out.channels <= 0 || out.sampleRate <= 0) {
+        error = "missing fmt or data chunk";
+        return false;
+    }
+    int bytes = bits / 8;
+    bool isFloat = format == 3 && bits == 32;
+    bool isPcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    if (!isFloat && !isPcm) {
+        error = "unsupported format " + std::to_string(format) + " / " + std::to_string(bits) + " bit";
+        return false;
+    }
+
+    size_t count = pcmBytes / bytes;
+    count -= count % out.channels;
+    out.samples.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char *p = pcm + i * bytes;
+        float v;
+        if (isFloat) {
+            std::memcpy(&v, p, 4);
+        } else if (bits == 16) {
+            v = (int16_t)le16(p) / 32768.0f;
+        } else if (bits == 24) {
+            int32_t x = (int32_t)((p[0] << 8) | (p[1] << 16) | ((uint32_t)p[2] << 24)) >> 8;
+            v = x / 8388608.0f;
+        } else {
+            v = (int32_t)le32(p) / 2147483648.0f;
+        }
+        out.samples[i] = v;
+    }
+    return true;
+}
+
+} // namespace WavReader
@@ -2,14 +2,21 @@
 #include "ofApp.h"
 #include "Core.h"
 #include "ofAppNoWindow.h"
+#include "BeatEvalRunner.h"
 
 int main(int argc, char *argv[]) {
     bool headless = false;
+    bool beatEval = false;
     for (int i = 0; i < argc; i++) {
-        if (std::string(argv[i]) == "--headless") {
-            headless = true;
-            break;
-        }
+        if (std::string(argv[i]) == "--headless") headless = true;
+        if (std::string(argv[i]) == "--beat-eval") beatEval = true;
+    }
+
+    if (beatEval) {
+        // Offline beat tracker evaluation, no window or network; wins over
+        // --headless so scripted runs always exit
+        BeatEvalRunner eval;
+        return eval.run(std::vector<std::string>(argv + 1, argv + argc));
     }
 
     if (headless) {
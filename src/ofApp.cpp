@@ -8,16 +8,6 @@ void ofApp::setup() {
     core.setup(bHeadless);
     ofSetFrameRate(60);
 
-    // Setup Audio Input for Beat Tracker
-    ofSoundStreamSettings settings;
-    settings.numOutputChannels = 0;
-    settings.numInputChannels = 1;
-    settings.sampleRate = 22050; // Required by BeatNet
-    settings.bufferSize = 512;
-    settings.numBuffers = 4;
-    settings.setInListener(this);
-    soundStream.setup(settings);
-
     if (!bHeadless) {        ofSetVerticalSync(true);
         ofBackground(20);
         ofSetWindowTitle("invasiv " + string(VERSION_NAME));
@@ -111,7 +101,7 @@ void ofApp::mouseReleased(int x, int y, int button) {
 }
 
 void ofApp::keyPressed(int key) {
-    if (!core.net.isEditing()) core.stateMgr.processKey(key, core.warper, core.net);
+    if (!core.net.isEditing()) core.stateMgr.processKey(key, core.warper, core.net, core.scheduler, core.metro);
     if (key == 'f') core.identity.toggleFullscreen();
     if (key == 'h') { helpTimer = (helpTimer > 0) ? 0 : 15.0f; }
     if (key == 'm') { core.warper.reset(); core.net.setRole(ROLE_MASTER_EDIT); core.syncFullState(); }
@@ -124,6 +114,3 @@ void ofApp::exit() {
     core.exit();
 }
 
-void ofApp::audioIn(ofSoundBuffer & input) {
-    core.tracker.audioIn(input);
-}
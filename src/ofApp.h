@@ -17,14 +17,10 @@ public:
     void onFilesChanged(std::vector<std::string>& files);
     void exit();
     
-    void audioIn(ofSoundBuffer & input);
-
     bool bHeadless = false;
     Core core;
     GuiManager gui;
     
-    ofSoundStream soundStream;
-    
     char pathInputBuf[256];
     
     float helpTimer = 15.0f;
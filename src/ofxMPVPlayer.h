@@ -5,12 +5,17 @@
 #include <mpv/render_gl.h>
 #include <GLFW/glfw3.h> 
 #include "Metronome.h"
+#include "VideoPLL.h"
 
 class ofxMPVPlayer : public ofBaseVideoPlayer {
 public:
     Metronome* metro = nullptr;
     float duration = 0;
 
+    // Called from update() when the video size is known, before the player
+    // allocates its own FBOs. Callers may route output elsewhere via setExternalTarget.
+    std::function<void(int w, int h)> onVideoReconfig;
+
     ofxMPVPlayer() {
         ctx = mpv_create();
         if (!ctx) {
@@ -27,6 +32,12 @@ public:
         if (mpv_initialize(ctx) < 0) {
             ofLogError("ofxMPVPlayer") << "Failed to initialize mpv";
         }
+
+        // Delivered as MPV_EVENT_PROPERTY_CHANGE so update() never blocks on the core lock
+        mpv_observe_property(ctx, OBS_PERCENT_POS, "percent-pos", MPV_FORMAT_DOUBLE);
+        mpv_observe_property(ctx, OBS_TIME_POS, "time-pos", MPV_FORMAT_DOUBLE);
+        mpv_observe_property(ctx, OBS_DURATION, "duration", MPV_FORMAT_DOUBLE);
+        mpv_observe_property(ctx, OBS_PAUSE, "pause", MPV_FORMAT_FLAG);
     }
 
     ~ofxMPVPlayer() {
@@ -35,15 +46,29 @@ public:
 
     bool load(std::string name) override {
         pendingURI = ofToDataPath(name, true);
+        beatMap = loadBeatMap(pendingURI);
         bNeedToLoad = true;
         return true; 
     }
 
+    // Optional sidecar "<clip>.beats.json": {"beats": 16, "anchor": 0.0}
+    static ClipBeatMap loadBeatMap(const std::string &clipPath) {
+        ClipBeatMap m;
+        std::string path = clipPath + ".beats.json";
+        if (!ofFile::doesFileExist(path, false)) return m;
+        ofJson j = ofLoadJson(path);
+        if (!j.is_object()) return m;
+        m.beats = j.value("beats", 0.0);
+        m.anchor = j.value("anchor", 0.0);
+        return m;
+    }
+
     void loadAsync(std::string name) override {
         load(name);
     }
 
     void close() override {
+        if (glfwGetCurrentContext()) releaseBuffers();
         if (mpv_gl) {
             mpv_render_context_free(mpv_gl);
             mpv_gl = nullptr;
@@ -55,33 +80,44 @@ public:
         bLoaded = false;
     }
 
+    // Stops playback and forgets the current clip but keeps the mpv core and
+    // render context alive so the player can be handed to another clip.
+    void unload() {
+        if (ctx) {
+            const char *cmd[] = {"stop", NULL};
+            mpv_command(ctx, cmd);
+            setSpeed(1.0f);
+            // mpv keeps pause across loadfile; the next clip should start playing
+            int flag = 0;
+            mpv_set_property(ctx, "pause", MPV_FORMAT_FLAG, &flag);
+            // Drop events from the old clip so the next owner doesn't see its reconfig
+            while (mpv_wait_event(ctx, 0)->event_id != MPV_EVENT_NONE) {}
+        }
+        onVideoReconfig = nullptr;
+        metro = nullptr;
+        duration = 0;
+        percentPos = timePos = 0;
+        bLoaded = false;
+        bPaused = true;
+        bFrameNew = false;
+        bNeedToLoad = false;
+        pendingURI.clear();
+        beatMap = ClipBeatMap();
+        pll.reset();
+        lastSyncMicros = 0;
+        videoWidth = videoHeight = 0;
+        clearExternalTarget();
+        releaseBuffers();
+    }
+
+    // Creates the render context ahead of the first load. Needs the GL thread.
+    void prepareGL() {
+        if (ctx && !mpv_gl && glfwGetCurrentContext()) initGL();
+    }
+
     void update() override {
         if (!ctx) return;
 
-        // Perform Metronome Sync Skewing
-        if (metro && bLoaded && !bPaused && duration > 0) {
-            float metroBeat = metro->getBeat();
-            float videoBeatCount = duration * 2.0f; // Assumed 2 beats per second (120 BPM)
-            
-            // Where we should be in the video (0.0 to 1.0)
-            float targetPos = fmod(metroBeat, videoBeatCount) / videoBeatCount;
-            
-            double currentPos = 0;
-            mpv_get_property(ctx, "percent-pos", MPV_FORMAT_DOUBLE, &currentPos);
-            currentPos /= 100.0; // mpv uses 0-100 for percent-pos
-
-            float diff = targetPos - (float)currentPos;
-            // Handle wrap around
-            if (diff > 0.5f) diff -= 1.0f;
-            if (diff < -0.5f) diff += 1.0f;
-
-            float baseSpeed = metro->bpm / 120.0f;
-            float skew = ofClamp(diff * 2.0f, -0.1f, 0.1f); // Simple P control
-            double finalSpeed = baseSpeed + skew;
-            
-            mpv_set_property(ctx, "speed", MPV_FORMAT_DOUBLE, &finalSpeed);
-        }
-
         if (!mpv_gl) {
             if (glfwGetCurrentContext()) {
                 initGL();
@@ -110,25 +146,46 @@ public:
                 mpv_get_property(ctx, "width", MPV_FORMAT_INT64, &w);
                 mpv_get_property(ctx, "height", MPV_FORMAT_INT64, &h);
                 
-                double d = 0;
-                mpv_get_property(ctx, "duration", MPV_FORMAT_DOUBLE, &d);
-                duration = (float)d;
-
                 if (w > 0 && h > 0) {
-                    if (!fbo.isAllocated() || fbo.getWidth() != w || fbo.getHeight() != h) {
-                        fbo.allocate(w, h, GL_RGB);
-                        fbo.getTexture().setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+                    videoWidth = (int)w;
+                    videoHeight = (int)h;
+                    if (onVideoReconfig) onVideoReconfig(videoWidth, videoHeight);
+                    if (externalFbo == 0 && (!fbos[0].isAllocated() || fbos[0].getWidth() != w || fbos[0].getHeight() != h)) {
+                        releaseBuffers();
+                        for (auto &b : fbos) {
+                            b.allocate(w, h, GL_RGB);
+                            b.getTexture().setTextureMinMagFilter(GL_LINEAR, GL_LINEAR);
+                        }
                     }
                 }
-            } 
+            } else if (event->event_id == MPV_EVENT_PROPERTY_CHANGE) {
+                onPropertyChange(event->reply_userdata, (mpv_event_property *)event->data);
+            }
+        }
+
+        // Lock clip beat phase to the metronome
+        if (metro && bLoaded && !bPaused && duration > 0) {
+            uint64_t now = ofGetElapsedTimeMicros();
+            double dt = lastSyncMicros ? (now - lastSyncMicros) / 1e6 : 0.0;
+            lastSyncMicros = now;
+            VideoPLL::Output out = pll.update(timePos, duration, metro->getBeat(), metro->bpm, dt, beatMap);
+            if (out.seek) {
+                std::string t = std::to_string(out.seekTime);
+                const char *cmd[] = {"seek", t.c_str(), "absolute+exact", NULL};
+                mpv_command_async(ctx, 0, cmd);
+                timePos = out.seekTime;
+            }
+            if (std::abs(out.speed - currentSpeed) > speedEpsilon) setSpeed((float)out.speed);
+        } else {
+            lastSyncMicros = 0;
         }
 
+        bFrameNew = swapIfReady();
         uint64_t flags = mpv_render_context_update(mpv_gl);
         if (flags & MPV_RENDER_UPDATE_FRAME) {
             renderFrame();
-            bFrameNew = true;
-        } else {
-            bFrameNew = false;
+            if (externalFbo) bFrameNew = true;
+            else bFrameNew = swapIfReady() || bFrameNew;
         }
     }
 
@@ -164,20 +221,11 @@ public:
     }
 
     float getPosition() const override {
-        if (!ctx) return 0.0f;
-        double pos = 0;
-        double dur = getDuration();
-        mpv_get_property(ctx, "time-pos", MPV_FORMAT_DOUBLE, &pos);
-        if (dur > 0) return (float)(pos / dur);
+        if (duration > 0) return (float)(timePos / duration);
         return 0.0f;
     }
 
-    float getDuration() const override {
-        if (!ctx) return 0.0f;
-        double d = 0;
-        mpv_get_property(ctx, "duration", MPV_FORMAT_DOUBLE, &d);
-        return (float)d;
-    }
+    float getDuration() const override { return duration; }
 
     void setVolume(float volume) override {
         if (!ctx) return;
@@ -194,44 +242,97 @@ public:
     void setSpeed(float speed) override {
         if (!ctx) return;
         double s = (double)speed;
-        mpv_set_property(ctx, "speed", MPV_FORMAT_DOUBLE, &s);
+        mpv_set_property_async(ctx, 0, "speed", MPV_FORMAT_DOUBLE, &s);
+        currentSpeed = speed;
     }
+    float getSpeed() const override { return currentSpeed; }
 
     bool isFrameNew() const override { return bFrameNew; }
     bool isLoaded() const override { return bLoaded; }
     bool isPlaying() const override { return !bPaused; }
     bool isPaused() const override { return bPaused; }
-    float getWidth() const override { return fbo.getWidth(); }
-    float getHeight() const override { return fbo.getHeight(); }
+    float getWidth() const override { return externalFbo ? externalWidth : (hasFront ? fbos[front].getWidth() : 0); }
+    float getHeight() const override { return externalFbo ? externalHeight : (hasFront ? fbos[front].getHeight() : 0); }
+    int getVideoWidth() const { return videoWidth; }
+    int getVideoHeight() const { return videoHeight; }
+
+    // Render into an FBO owned by someone else (e.g. a TextureArrayPool layer).
+    // The player's own FBO is released while an external target is set.
+    void setExternalTarget(GLuint fboId, int w, int h) {
+        externalFbo = fboId;
+        externalWidth = w;
+        externalHeight = h;
+        releaseBuffers();
+    }
+
+    void clearExternalTarget() {
+        externalFbo = 0;
+        externalWidth = externalHeight = 0;
+    }
+
+    bool hasExternalTarget() const { return externalFbo != 0; }
+
+    // Fence of the last render. Consumers on another context can wait on it
+    // before sampling; same-context draws are ordered by GL already.
+    GLsync getFrameFence() const { return externalFbo ? externalFence : fences[front]; }
 
     void draw(float x, float y, float w, float h) {
-        if (fbo.isAllocated()) {
+        if (hasFront) {
             ofPushStyle();
             ofEnableBlendMode(OF_BLENDMODE_DISABLED);
-            fbo.draw(x, y, w, h);
+            fbos[front].draw(x, y, w, h);
             ofPopStyle();
         }
     }
     
     void draw(float x, float y) { draw(x, y, getWidth(), getHeight()); }
-    ofTexture * getTexturePtr() override { return fbo.isAllocated() ? &fbo.getTexture() : nullptr; }
-    ofTexture& getTexture() { return fbo.getTexture(); }
+    ofTexture * getTexturePtr() override { return hasFront ? &fbos[front].getTexture() : nullptr; }
+    ofTexture& getTexture() { return fbos[front].getTexture(); }
     const ofPixels& getPixels() const override { static ofPixels dummy; return dummy; }
     ofPixels& getPixels() override { static ofPixels dummy; return dummy; }
     bool setPixelFormat(ofPixelFormat pixelFormat) override { internalPixelFormat = pixelFormat; return true; }
     ofPixelFormat getPixelFormat() const override { return internalPixelFormat; }
     mpv_handle* getMPV() { return ctx; }
+    const VideoPLL &getPLL() const { return pll; }
+    const ClipBeatMap &getBeatMap() const { return beatMap; }
 
 private:
+    enum ObservedProperty : uint64_t {
+        OBS_PERCENT_POS = 1,
+        OBS_TIME_POS,
+        OBS_DURATION,
+        OBS_PAUSE
+    };
+
     mpv_handle *ctx = nullptr;
     mpv_render_context *mpv_gl = nullptr;
-    ofFbo fbo;
+    // mpv renders into the back buffer; it becomes the front one once its fence signals
+    ofFbo fbos[2];
+    GLsync fences[2] = {nullptr, nullptr};
+    GLsync externalFence = nullptr;
+    int front = 0;
+    bool hasFront = false;
+    bool backPending = false;
     bool bLoaded = false;
     bool bPaused = false;
     bool bFrameNew = false;
     std::string pendingURI;
     bool bNeedToLoad = false;
     ofPixelFormat internalPixelFormat = OF_PIXELS_RGB;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    // Cached from property-change events
+    double percentPos = 0;
+    double timePos = 0;
+    // Last speed sent to mpv; sync corrections smaller than speedEpsilon are skipped
+    float currentSpeed = 1.0f;
+    float speedEpsilon = 0.002f;
+    ClipBeatMap beatMap;
+    VideoPLL pll;
+    uint64_t lastSyncMicros = 0;
+    GLuint externalFbo = 0;
+    int externalWidth = 0;
+    int externalHeight = 0;
 
     static void *get_proc_address(void *ctx, const char *name) {
         (void)ctx;
@@ -249,19 +350,82 @@ private:
         if (mpv_render_context_create(&mpv_gl, ctx, params) < 0) ofLogError("ofxMPVPlayer") << "Failed to create mpv GL context";
     }
 
+    void onPropertyChange(uint64_t id, mpv_event_property *prop) {
+        if (!prop->data) {
+            // Property became unavailable (e.g. no file loaded)
+            if (id == OBS_PERCENT_POS) percentPos = 0;
+            else if (id == OBS_TIME_POS) timePos = 0;
+            else if (id == OBS_DURATION) duration = 0;
+            return;
+        }
+        if (prop->format == MPV_FORMAT_DOUBLE) {
+            double v = *(double *)prop->data;
+            if (id == OBS_PERCENT_POS) percentPos = v;
+            else if (id == OBS_TIME_POS) timePos = v;
+            else if (id == OBS_DURATION) duration = (float)v;
+        } else if (prop->format == MPV_FORMAT_FLAG && id == OBS_PAUSE) {
+            bPaused = *(int *)prop->data != 0;
+        }
+    }
+
+    void releaseBuffers() {
+        for (int i = 0; i < 2; i++) {
+            if (fences[i]) glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+            if (fbos[i].isAllocated()) fbos[i].clear();
+        }
+        if (externalFence) glDeleteSync(externalFence);
+        externalFence = nullptr;
+        front = 0;
+        hasFront = false;
+        backPending = false;
+    }
+
+    bool swapIfReady() {
+        int back = 1 - front;
+        if (!backPending || !fences[back]) return false;
+        GLenum r = glClientWaitSync(fences[back], GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (r != GL_ALREADY_SIGNALED && r != GL_CONDITION_SATISFIED) return false;
+        front = back;
+        hasFront = true;
+        backPending = false;
+        return true;
+    }
+
+    // Renders straight into the target FBO. mpv draws every pixel (including
+    // letterbox borders), so the target is never cleared first.
     void renderFrame() {
-        if (!fbo.isAllocated()) return;
-        fbo.begin();
-        ofClear(0, 0, 0, 255); 
-        int fbo_id = (int)fbo.getId();
-        mpv_opengl_fbo mpv_fbo = { .fbo = fbo_id, .w = (int)fbo.getWidth(), .h = (int)fbo.getHeight(), .internal_format = 0 };
-        int flip_y = 1; 
+        GLuint target;
+        int w, h;
+        GLsync *fence;
+        if (externalFbo) {
+            target = externalFbo;
+            w = externalWidth;
+            h = externalHeight;
+            fence = &externalFence;
+        } else {
+            int back = 1 - front;
+            if (!fbos[back].isAllocated()) return;
+            target = fbos[back].getId();
+            w = (int)fbos[back].getWidth();
+            h = (int)fbos[back].getHeight();
+            fence = &fences[back];
+            backPending = true;
+        }
+
+        GLint prevFbo = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+        mpv_opengl_fbo mpv_fbo = { .fbo = (int)target, .w = w, .h = h, .internal_format = 0 };
+        int flip_y = 1;
         mpv_render_param params[] = {
             {MPV_RENDER_PARAM_OPENGL_FBO, &mpv_fbo},
             {MPV_RENDER_PARAM_FLIP_Y, &flip_y},
             {MPV_RENDER_PARAM_INVALID, nullptr}
         };
         mpv_render_context_render(mpv_gl, params);
-        fbo.end();
+        glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+
+        if (*fence) glDeleteSync(*fence);
+        *fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
 };
@@ -0,0 +1,91 @@
+import json
+import math
+import os
+import random
+import struct
+import subprocess
+import sys
+import wave
+
+# Offline beat tracker regression: renders click tracks with known beats,
+# runs `invasiv --beat-eval` over them and checks the scores in the report.
+
+MIN_F = 0.8
+
+def render_click_track(path, bpm, beats_per_bar, seconds, seed, sample_rate=22050):
+    """Kick-like clicks on every beat, louder and lower on the downbeat, over
+    quiet noise. Writes <path>.wav and <path>.beats (time, position in bar)."""
+    rng = random.Random(seed)
+    n = int(seconds * sample_rate)
+    samples = [rng.uniform(-0.01, 0.01) for _ in range(n)]
+    interval = 60.0 / bpm
+    offset = 0.25
+    beats = []
+    k = 0
+    while offset + k * interval < seconds - 0.5:
+        t = offset + k * interval
+        position = k % beats_per_bar + 1
+        beats.append((t, position))
+        freq, amp = (80.0, 0.9) if position == 1 else (160.0, 0.5)
+        start = int(t * sample_rate)
+        attack = int(0.0068 * sample_rate)
+        for i in range(int(0.12 * sample_rate)):
+            if start + i >= n:
+                break
+            env = math.exp(-i / (0.025 * sample_rate))
+            # Pitch drop plus a short noise burst for the attack
+            phase = 2 * math.pi * freq * (i / sample_rate) * (1.0 + 2.0 * math.exp(-i / (0.009 * sample_rate)))
+            click = math.sin(phase) + (rng.uniform(-1, 1) if i < attack else 0.0)
+            samples[start + i] += amp * env * click * 0.7
+        k += 1
+
+    with wave.open(path + ".wav", "wb") as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(sample_rate)
+        w.writeframes(b"".join(struct.pack("<h", max(-32767, min(32767, int(s * 32767)))) for s in samples))
+    with open(path + ".beats", "w") as f:
+        for t, position in beats:
+            f.write(f"{t:.6f}\t{position}\n")
+
+def test_beat_eval():
+    print("--- Starting Beat Tracker Evaluation Test ---")
+    bin_path = os.path.abspath("./bin/invasiv")
+    if not os.path.exists(bin_path):
+        print(f"Error: Binary {bin_path} not found.")
+        return False
+
+    corpus = os.path.abspath("test_env/beat_eval")
+    os.makedirs(corpus, exist_ok=True)
+    render_click_track(f"{corpus}/click_120_4", 120.0, 4, 30.0, 1)
+    render_click_track(f"{corpus}/click_96_3", 96.0, 3, 30.0, 2)
+    # Device-rate files go through the tracker's resampler
+    render_click_track(f"{corpus}/click_140_4", 140.0, 4, 30.0, 3, 44100)
+    render_click_track(f"{corpus}/click_110_4", 110.0, 4, 30.0, 4, 48000)
+
+    report_path = os.path.abspath("test_env/beat_eval_report.json")
+    result = subprocess.run([bin_path, "--beat-eval", corpus, "--report", report_path, "--min-f", str(MIN_F)],
+                            cwd=os.path.dirname(bin_path), capture_output=True, text=True, timeout=600)
+    print(result.stdout)
+    print(result.stderr)
+    if not os.path.exists(report_path):
+        print("Error: no report written")
+        return False
+
+    with open(report_path) as f:
+        report = json.load(f)
+    ok = result.returncode == 0
+    for entry in report["files"]:
+        print(f"{entry['file']}: F {entry.get('f', 0):.3f}, CMLt {entry.get('cmlt', 0):.3f}, "
+              f"{entry['bpm']:.1f} BPM, x{entry['realtimeFactor']:.1f} realtime")
+        if entry.get("f", 0) < MIN_F:
+            ok = False
+        # Offline evaluation must run faster than realtime
+        if entry["realtimeFactor"] < 1.0:
+            print(f"Error: {entry['file']} analysed slower than realtime")
+            ok = False
+    print("Beat Eval Test " + ("PASSED" if ok else "FAILED"))
+    return ok
+
+if __name__ == "__main__":
+    sys.exit(0 if test_beat_eval() else 1)
@@ -21,11 +21,27 @@ namespace of {
 
 // Include the class under test
 #include "../src/Metronome.h"
+#include "../src/ClusterClock.h"
+#include "../src/ControlPointIndex.h"
+#include "../src/ContentLifecycle.h"
+#include "../src/VideoPLL.h"
+#include "../src/BeatScheduler.h"
+#include "../src/SpscRing.h"
+#include "../src/SpectralFeatures.h"
+#include "../src/LatencyStats.h"
+#include "../src/Resampler.h"
+#include "../src/LevelMeter.h"
+#include "../src/BeatParticleFilter.h"
+#include "../src/TempoSync.h"
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <atomic>
 
 void test_metronome_logic() {
     Metronome m;
     m.bpm = 60.0f; // 1 beat per second
-    m.referenceTime = ofGetElapsedTimeMillis();
+    m.referenceTimeNs = m.nowNs();
     m.beatsPerBar = 4;
 
     std::cout << "Testing Metronome at 60 BPM..." << std::endl;
@@ -36,7 +52,7 @@ void test_metronome_logic() {
     // Wait ~1.1 seconds (should be into beat 2)
     std::this_thread::sleep_for(std::chrono::milliseconds(1100));
     
-    float beat = m.getBeat();
+    double beat = m.getBeat();
     std::cout << "Beat after 1.1s: " << beat << std::endl;
     assert(beat >= 1.0f && beat < 2.0f);
     assert(m.getBeatInBar() == 2);
@@ -54,6 +70,53 @@ void test_metronome_logic() {
     std::cout << "Metronome Unit Tests PASSED" << std::endl;
 }
 
+void test_metronome_uptime() {
+    std::cout << "Testing Metronome phase after long uptimes..." << std::endl;
+    const int64_t day = 24LL * 3600 * Timebase::NS_PER_SEC;
+    // Periods that are whole ns, so the exact phase is integer arithmetic
+    const float tempos[] = {120.0f, 128.0f, 150.0f};
+    const int64_t periods[] = {500000000, 468750000, 400000000};
+
+    double maxErr = 0;
+    for (int i = 0; i < 3; i++) {
+        Metronome m;
+        m.bpm = tempos[i];
+        // Beat 1 set at boot of a steady clock that has been up for a while
+        m.referenceTimeNs = 3 * day + 123456789;
+        for (int64_t t = 0; t <= 30 * day; t += day / 7 + 987654321) {
+            int64_t now = m.referenceTimeNs + t;
+            double beat = m.getBeatAt(now);
+            double phase = beat - std::floor(beat);
+            double expected = (double)(t % periods[i]) / periods[i];
+            double err = std::abs(phase - expected);
+            err = std::min(err, 1.0 - err);
+            maxErr = std::max(maxErr, err);
+            assert(std::llabs((int64_t)std::llround(beat - phase) - t / periods[i]) <= 1);
+            // A frame later the phase must have advanced by exactly one frame's worth
+            double next = m.getBeatAt(now + 16666667) - beat;
+            assert(std::abs(next - 16666667.0 / periods[i]) < 1e-6);
+        }
+    }
+    std::cout << "Max phase error after 30 days: " << maxErr << " beats" << std::endl;
+    assert(maxErr < 1e-6);
+
+    // Float seconds, as used before, can't even resolve a 60fps frame at that age
+    float old = (float)(30 * 24 * 3600);
+    assert(old + 1.0f / 60.0f == old);
+
+    // Tap tempo still lands exactly after a month of uptime
+    Metronome m;
+    int64_t t0 = 30 * day + 1;
+    m.tapAt(t0);
+    m.tapAt(t0 + 500 * Timebase::NS_PER_MS);
+    m.tapAt(t0 + 1000 * Timebase::NS_PER_MS);
+    assert(m.bpm == 120.0f);
+    assert(m.referenceTimeNs == t0 + 1000 * Timebase::NS_PER_MS);
+    assert(m.getBeatAt(t0 + 1250 * Timebase::NS_PER_MS) == 0.5);
+
+    std::cout << "Metronome Uptime Unit Tests PASSED" << std::endl;
+}
+
 void test_skew_logic() {
     std::cout << "Testing Video Skew Math..." << std::endl;
     
@@ -87,10 +150,871 @@ void test_skew_logic() {
     std::cout << "Skew Logic Unit Tests PASSED" << std::endl;
 }
 
+void test_control_point_index() {
+    std::cout << "Testing Control Point Index..." << std::endl;
+
+    struct Pt { float x, y, z; };
+    int rows = 24, cols = 24;
+    std::vector<Pt> pts;
+    for (int y = 0; y <= rows; y++)
+        for (int x = 0; x <= cols; x++)
+            pts.push_back({(float)x / cols, (float)y / rows, 0});
+
+    ControlPointIndex index;
+    index.rebuild(pts);
+
+    auto bruteNearest = [&](float x, float y, float w, float h) {
+        float minD = 30;
+        int hit = -1;
+        for (size_t i = 0; i < pts.size(); i++) {
+            float d = std::hypot(x - pts[i].x * w, y - pts[i].y * h);
+            if (d < minD) { minD = d; hit = (int)i; }
+        }
+        return hit;
+    };
+
+    // Picking matches the old linear scan on a 4K viewport
+    unsigned int seed = 1234;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+    for (int i = 0; i < 2000; i++) {
+        float x = rnd() * 3840, y = rnd() * 2160;
+        assert(index.nearest(pts, x, y, 3840, 2160, 30) == bruteNearest(x, y, 3840, 2160));
+    }
+
+    // Moving a point updates its cell and grows the cached bounds
+    int idx = 12 + 12 * (cols + 1);
+    Pt old = pts[idx];
+    pts[idx] = {0.9f, 0.1f, 0};
+    index.update(pts, idx, old.x, old.y);
+    assert(index.nearest(pts, 0.9f * 1000, 0.1f * 1000, 1000, 1000, 30) == idx);
+
+    old = pts[0];
+    pts[0] = {-0.2f, 0.5f, 0};
+    index.update(pts, 0, old.x, old.y);
+    assert(index.contains(pts, -0.1f, 0.5f));
+
+    // Moving the boundary point back in shrinks the box again
+    old = pts[0];
+    pts[0] = {0.5f, 0.5f, 0};
+    index.update(pts, 0, old.x, old.y);
+    assert(!index.contains(pts, -0.1f, 0.5f));
+    float x0, y0, x1, y1;
+    index.getBounds(pts, x0, y0, x1, y1);
+    assert(x0 == 0.0f && x1 == 1.0f && y0 == 0.0f && y1 == 1.0f);
+
+    // Running centroid follows single-point edits without a rescan
+    float cx, cy;
+    index.getCentroid(cx, cy);
+    double sx = 0, sy = 0;
+    for (auto &p : pts) { sx += p.x; sy += p.y; }
+    assert(std::abs(cx - sx / pts.size()) < 1e-5 && std::abs(cy - sy / pts.size()) < 1e-5);
+
+    // Rect query returns exactly the points inside, sorted
+    std::vector<int> sel;
+    index.queryRect(pts, 0.49f, 0.49f, 0.0f, 0.0f, sel);
+    size_t expected = 0;
+    for (auto &p : pts) if (p.x >= 0 && p.x <= 0.49f && p.y >= 0 && p.y <= 0.49f) expected++;
+    assert(sel.size() == expected);
+    assert(std::is_sorted(sel.begin(), sel.end()));
+
+    std::cout << "Control Point Index Unit Tests PASSED" << std::endl;
+}
+
+struct MockPlayer {
+    static std::atomic<int> live;
+    uint64_t ticket;
+    MockPlayer(uint64_t t) : ticket(t) { live++; }
+    ~MockPlayer() { live--; }
+};
+std::atomic<int> MockPlayer::live{0};
+
+void test_content_lifecycle() {
+    std::cout << "Testing Content Lifecycle..." << std::endl;
+
+    using Lifecycle = ContentLifecycle<MockPlayer>;
+    Lifecycle lc;
+
+    // Single-threaded transitions
+    uint64_t t = lc.beginLoad();
+    assert(t != 0 && lc.getState() == Lifecycle::LOADING);
+    assert(lc.beginLoad() == 0);
+    assert(lc.finishLoad(t, std::make_shared<MockPlayer>(t)));
+    assert(lc.getState() == Lifecycle::READY && lc.get());
+    assert(lc.evict() && lc.getState() == Lifecycle::EVICTING && !lc.get());
+    lc.finishEvict();
+    assert(lc.getState() == Lifecycle::DORMANT);
+
+    // Evicted mid-load: the late result is rejected
+    t = lc.beginLoad();
+    lc.evict();
+    lc.finishEvict();
+    assert(!lc.finishLoad(t, std::make_shared<MockPlayer>(t)));
+    assert(lc.getState() == Lifecycle::DORMANT && !lc.get());
+    assert(MockPlayer::live == 0);
+
+    // Stress: a loader thread completes loads while the main thread reloads and evicts
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<uint64_t> jobs;
+    bool done = false;
+    std::atomic<int> published{0}, rejected{0};
+    std::thread loader([&]() {
+        std::unique_lock<std::mutex> lock(m);
+        while (true) {
+            cv.wait(lock, [&] { return done || !jobs.empty(); });
+            if (jobs.empty()) break;
+            uint64_t ticket = jobs.front();
+            jobs.pop_front();
+            lock.unlock();
+            auto p = std::make_shared<MockPlayer>(ticket);
+            if (lc.finishLoad(ticket, p)) published++;
+            else rejected++;
+            lock.lock();
+        }
+    });
+
+    unsigned int seed = 99;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 16; };
+    uint64_t lastTicket = 0;
+    int loads = 0;
+    for (int i = 0; i < 20000; i++) {
+        unsigned int r = rnd() % 4;
+        if (r == 0) {
+            uint64_t tk = lc.beginLoad();
+            if (tk) {
+                lastTicket = tk;
+                loads++;
+                std::lock_guard<std::mutex> lock(m);
+                jobs.push_back(tk);
+                cv.notify_one();
+            }
+        } else if (r == 1) {
+            lc.evict();
+            lc.finishEvict();
+        } else {
+            auto p = lc.get();
+            if (p) assert(p->ticket == lastTicket);
+            Lifecycle::State st = lc.getState();
+            assert(st != Lifecycle::EVICTING); // only this thread evicts, and it always finishes
+        }
+        if (i % 500 == 0) std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        done = true;
+        cv.notify_one();
+    }
+    loader.join();
+    lc.evict();
+    lc.finishEvict();
+
+    assert(loads > 100);
+    assert(published + rejected == loads);
+    assert(MockPlayer::live == 0);
+    std::cout << "  " << loads << " loads, " << published << " published, " << rejected << " rejected" << std::endl;
+    std::cout << "Content Lifecycle Unit Tests PASSED" << std::endl;
+}
+
+void test_video_pll() {
+    std::cout << "Testing Video PLL..." << std::endl;
+
+    // 8-beat clip that plays at ~130 BPM natively, metronome at 128 BPM
+    const double duration = 3.7, bpm = 128.0, dt = 1.0 / 60.0;
+    ClipBeatMap map;
+    map.beats = 8;
+    map.anchor = 0.1;
+    VideoPLL pll;
+
+    // Player model: position advances at the commanded speed and is reported
+    // quantized to 30fps video frames plus a little noise
+    unsigned int seed = 7;
+    auto noise = [&]() { seed = seed * 1664525u + 1013904223u; return ((seed >> 8) / 16777216.0 - 0.5) * 0.004; };
+    double clipTime = 1.0, speed = 1.0;
+    auto step = [&](double t) {
+        double reported = std::floor(clipTime * 30.0) / 30.0 + noise();
+        auto out = pll.update(reported, duration, t * bpm / 60.0, bpm, dt, map);
+        if (out.seek) clipTime = out.seekTime;
+        speed = out.speed;
+        clipTime = std::fmod(clipTime + speed * dt, duration);
+        return out;
+    };
+
+    // Starts out of phase; must lock without seeking
+    clipTime = 0.1 + 0.4 * duration / 8; // 0.4 beats behind beat 0
+    int seeksBefore = pll.getSeekCount();
+    double t = 0;
+    for (; t < 15.0; t += dt) step(t);
+    assert(pll.getSeekCount() == seeksBefore);
+    assert(std::abs(pll.getRawPhaseError()) < 0.05);
+    double expectedBase = (bpm / 60.0) / (8 / duration);
+    assert(std::abs(speed / expectedBase - 1.0) < 0.02);
+
+    // A two-beat jump is beyond slewing range: one hard seek, then relock
+    clipTime = std::fmod(clipTime + 2 * duration / 8, duration);
+    int seeks = pll.getSeekCount();
+    for (double end = t + 5.0; t < end; t += dt) step(t);
+    assert(pll.getSeekCount() == seeks + 1);
+    assert(std::abs(pll.getRawPhaseError()) < 0.05);
+    assert(!pll.getHistory().empty());
+
+    // No sidecar: 0.5s per beat, so base speed is bpm/120 like the old sync
+    ClipBeatMap none;
+    VideoPLL plain;
+    auto out = plain.update(0, 4.0, 0, 90.0, dt, none);
+    assert(std::abs(out.speed - 0.75) < 1e-9);
+
+    std::cout << "  rms phase error " << pll.getRmsError() << " beats" << std::endl;
+    std::cout << "Video PLL Unit Tests PASSED" << std::endl;
+}
+
+void test_cluster_clock() {
+    std::cout << "Testing Cluster Clock..." << std::endl;
+
+    // Authority's clock runs 5.3s ahead of ours. Each leg takes 0.2ms on the
+    // wire plus up to 1ms of scheduling/poll delay, occasionally 20ms.
+    const int64_t trueOffset = 5300000000LL;
+    ClusterClock clock;
+    unsigned int seed = 42;
+    auto rnd = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0; };
+    auto leg = [&]() { return (int64_t)(200000 + rnd() * 1000000 + (rnd() < 0.1 ? 20000000 : 0)); };
+
+    int64_t local = 1000000000LL;
+    for (int i = 0; i < 64; i++) {
+        int64_t t0 = local;
+        int64_t t1 = t0 + leg() + trueOffset;
+        int64_t t2 = t1 + 50000;
+        int64_t t3 = t2 - trueOffset + leg();
+        clock.addSample(t0, t1, t2, t3);
+        local = t3 + 250000000;
+    }
+    assert(clock.isSynced());
+    // Sub-millisecond agreement despite frame-sized queueing jitter
+    assert(std::llabs(clock.getOffsetNs() - trueOffset) < 500000);
+    assert(clock.getRttNs() < 2000000);
+
+    // Two peers syncing to the same authority agree on beat phase
+    Metronome a, b;
+    ClusterClock cb;
+    cb.addSample(0, trueOffset + 100000, trueOffset + 100000, 200000);
+    a.clock = &clock;
+    b.clock = &cb;
+    a.bpm = b.bpm = 128.0f;
+    a.referenceTimeNs = b.referenceTimeNs = ClusterClock::localNowNs() + trueOffset;
+    assert(std::abs(a.getBeat() - b.getBeat()) < 0.01);
+
+    // A promoted peer keeps its timeline
+    int64_t before = clock.getOffsetNs();
+    clock.setMaster();
+    clock.addSample(0, 0, 0, 0);
+    assert(clock.getOffsetNs() == before && clock.isMaster());
+
+    std::cout << "Cluster Clock Unit Tests PASSED" << std::endl;
+}
+
+void test_beat_scheduler() {
+    std::cout << "Testing Beat Scheduler..." << std::endl;
+    const int64_t ms = Timebase::NS_PER_MS;
+    Metronome m;
+    m.bpm = 120.0f; // 500ms beats, 2s bars
+    m.beatsPerBar = 4;
+    m.referenceTimeNs = 1000 * ms;
+
+    // Next beat/bar after the lookahead
+    assert(BeatScheduler::quantize(m, QUANTIZE_BEAT, 1100 * ms, 100 * ms) == 1500 * ms);
+    assert(BeatScheduler::quantize(m, QUANTIZE_BEAT, 1450 * ms, 100 * ms) == 2000 * ms);
+    assert(BeatScheduler::quantize(m, QUANTIZE_BAR, 1100 * ms, 100 * ms) == 3000 * ms);
+    assert(BeatScheduler::quantize(m, QUANTIZE_BAR, 2950 * ms, 100 * ms) == 5000 * ms);
+    // Landing exactly on a boundary keeps it
+    assert(BeatScheduler::quantize(m, QUANTIZE_BEAT, 1400 * ms, 100 * ms) == 1500 * ms);
+    assert(BeatScheduler::quantize(m, QUANTIZE_NONE, 1234 * ms, 100 * ms) == 1334 * ms);
+    // Still exact a month in
+    int64_t month = 30LL * 24 * 3600 * Timebase::NS_PER_SEC;
+    assert(BeatScheduler::quantize(m, QUANTIZE_BAR, m.referenceTimeNs + month + ms, 0) == m.referenceTimeNs + month + 2000 * ms);
+
+    // Fires in time order, FIFO among equal targets, nothing early
+    BeatScheduler s;
+    std::vector<int> order;
+    s.schedule(3000, [&]() { order.push_back(3); });
+    s.schedule(1000, [&]() { order.push_back(1); });
+    s.schedule(2000, [&]() { order.push_back(2); });
+    s.schedule(2000, [&]() { order.push_back(22); });
+    assert(s.update(999) == 0 && order.empty());
+    assert(s.getPendingCount() == 4 && s.getNextTargetNs() == 1000);
+    assert(s.update(2000) == 3);
+    assert(order == std::vector<int>({1, 2, 22}));
+    assert(s.update(5000) == 1 && order.back() == 3);
+
+    // Bounded: a full queue refuses instead of blocking
+    for (size_t i = 0; i < BeatScheduler::CAPACITY; i++) assert(s.schedule(1, nullptr));
+    assert(!s.schedule(1, nullptr));
+    s.clear();
+    assert(s.getPendingCount() == 0 && s.schedule(1, nullptr));
+    s.clear();
+
+    // Producers on several threads while the consumer fires
+    const int producers = 4, perProducer = 5000;
+    std::atomic<int> fired{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; i++) {
+                while (!s.schedule(p * perProducer + i, [&]() { fired++; })) std::this_thread::yield();
+            }
+        });
+    }
+    std::thread consumer([&]() {
+        while (!done || fired < producers * perProducer) s.update(INT64_MAX);
+    });
+    for (auto &t : threads) t.join();
+    done = true;
+    consumer.join();
+    assert(fired == producers * perProducer);
+    assert(s.getPendingCount() == 0);
+
+    std::cout << "Beat Scheduler Unit Tests PASSED" << std::endl;
+}
+
+void test_spsc_ring() {
+    std::cout << "Testing SPSC Ring..." << std::endl;
+    SpscRing<float> r(1000);
+    assert(r.capacity() == 1024);
+
+    // Bulk writes wrap around; overflow is dropped and counted
+    std::vector<float> in(700), out(1024);
+    for (size_t i = 0; i < in.size(); i++) in[i] = (float)i;
+    assert(r.write(in.data(), 700) == 700);
+    assert(r.read(out.data(), 500) == 500 && out[499] == 499.0f);
+    assert(r.write(in.data(), 700) == 700); // wraps
+    assert(r.readAvailable() == 900);
+    assert(r.write(in.data(), 200) == 124);
+    assert(r.getOverrunCount() == 76);
+    assert(r.discard(200) == 200);
+    assert(r.read(out.data(), 1024) == 824);
+    assert(out[0] == 0.0f && out[699] == 699.0f && out[700] == 0.0f && out[823] == 123.0f);
+    assert(r.read(out.data(), 1) == 0);
+
+    // Audio-callback-sized blocks against hop-sized reads on another thread
+    SpscRing<float> ring(4096);
+    const int total = 2000000;
+    std::thread producer([&]() {
+        std::vector<float> block(512);
+        int next = 0;
+        while (next < total) {
+            int n = std::min((int)block.size(), total - next);
+            for (int i = 0; i < n; i++) block[i] = (float)(next + i);
+            size_t done = 0;
+            while (done < (size_t)n) {
+                size_t w = std::min<size_t>(n - done, ring.writeAvailable());
+                ring.write(block.data() + done, w);
+                done += w;
+                if (w == 0) std::this_thread::yield();
+            }
+            next += n;
+        }
+    });
+    std::vector<float> hop(441);
+    int expected = 0;
+    bool ordered = true;
+    while (expected < total) {
+        size_t n = ring.read(hop.data(), std::min<int>(hop.size(), total - expected));
+        for (size_t i = 0; i < n; i++) ordered &= hop[i] == (float)expected++;
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+    assert(ordered);
+    assert(ring.getOverrunCount() == 0);
+
+    std::cout << "SPSC Ring Unit Tests PASSED" << std::endl;
+}
+
+void test_spectral_features() {
+    std::cout << "Testing Spectral Features..." << std::endl;
+    const int bins = 1025, bands = 136;
+    // Overlapping log-spaced triangles, 30Hz - 17kHz at 22050Hz / 2048
+    std::vector<std::vector<float>> dense(bands, std::vector<float>(bins, 0.0f));
+    for (int b = 0; b < bands; b++) {
+        auto edge = [&](int k) { return 30.0 * std::pow(17000.0 / 30.0, k / (double)(bands + 1)) / (22050.0 / 2048); };
+        double lo = edge(b), mid = edge(b + 1), hi = edge(b + 2);
+        for (int i = 0; i < bins; i++) {
+            double w = i < mid ? (i - lo) / std::max(1e-9, mid - lo) : (hi - i) / std::max(1e-9, hi - mid);
+            if (w > 0) dense[b][i] = (float)w;
+        }
+        if ((int)std::round(mid) < bins) dense[b][(int)std::round(mid)] = std::max(dense[b][(int)std::round(mid)], 1.0f);
+    }
+    SparseFilterbank fb = SparseFilterbank::fromDense(dense, bins);
+    assert(fb.getNumBands() == bands);
+    std::cout << "  " << fb.getNumWeights() << " weights vs " << bands * bins << " dense" << std::endl;
+
+    std::vector<float> cpx(bins * 2);
+    for (size_t i = 0; i < cpx.size(); i++) cpx[i] = (float)std::sin(i * 0.37) * (1.0f + (i % 17));
+
+    // Reference: the previous per-hop code path
+    auto denseHop = [&](const std::vector<float> &c, std::vector<float> &prev, std::vector<float> &out) {
+        std::vector<float> mags(bins);
+        for (int i = 0; i < bins; i++) mags[i] = std::sqrt(c[2 * i] * c[2 * i] + c[2 * i + 1] * c[2 * i + 1]);
+        out.resize(bands * 2);
+        for (int b = 0; b < bands; b++) {
+            float e = 0;
+            for (int i = 0; i < bins; i++) e += mags[i] * dense[b][i];
+            float l = std::log10(1.0f + e);
+            out[bands + b] = std::max(0.0f, l - prev[b]);
+            prev[b] = l;
+            out[b] = l;
+        }
+    };
+    std::vector<float> mags(bins), energy(bands), out(bands * 2), prev(bands, 0.0f);
+    auto sparseHop = [&](const std::vector<float> &c) {
+        SpectralOps::magnitudes(c.data(), mags.data(), bins);
+        fb.apply(mags.data(), energy.data());
+        SpectralOps::logCompress(energy.data(), out.data(), bands);
+        SpectralOps::positiveDiff(out.data(), prev.data(), out.data() + bands, bands);
+    };
+
+    std::vector<float> ref, refPrev(bands, 0.0f);
+    for (int hop = 0; hop < 3; hop++) {
+        for (auto &v : cpx) v *= 1.1f;
+        denseHop(cpx, refPrev, ref);
+        sparseHop(cpx);
+        for (int i = 0; i < bands * 2; i++) assert(std::abs(ref[i] - out[i]) < 1e-4f * std::max(1.0f, std::abs(ref[i])));
+    }
+
+    // Per-hop cost, FFT excluded (it is unchanged)
+    const int hops = 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < hops; i++) denseHop(cpx, refPrev, ref);
+    auto t1 = std::chrono::steady_clock::now();
+    for (int i = 0; i < hops; i++) sparseHop(cpx);
+    auto t2 = std::chrono::steady_clock::now();
+    double denseUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / hops;
+    double sparseUs = std::chrono::duration<double, std::micro>(t2 - t1).count() / hops;
+    std::cout << "  per hop: dense " << denseUs << " us, sparse " << sparseUs << " us" << std::endl;
+    assert(sparseUs < denseUs);
+
+    std::cout << "Spectral Features Unit Tests PASSED" << std::endl;
+}
+
+// BeatNet's front-end: 1411-sample Hann frames every 441 samples at 22050Hz,
+// 705 bins, 24 bands/octave log filterbank, log10(1 + x), positive diff.
+// Frame k is centred on sample k * hop, like madmom's offline framing; the
+// tracker's streaming window ends at the newest sample instead, which is the
+// same frame half a window later.
+struct ReferenceFrontEnd {
+    static const int frameSize = 1411, hop = 441, bins = 705;
+    SparseFilterbank fb = SparseFilterbank::logarithmic(SparseFilterbank::fftFrequencies(bins, 22050.0));
+    std::vector<float> win, frame, windowed, mags, energy, prev;
+    std::vector<double> cosT, sinT;
+
+    ReferenceFrontEnd() : win(frameSize), frame(frameSize), windowed(frameSize), mags(bins),
+                          energy(fb.getNumBands()), prev(fb.getNumBands(), 0.0f) {
+        for (int i = 0; i < frameSize; i++) win[i] = (float)(0.5 - 0.5 * std::cos(2 * M_PI * i / (frameSize - 1)));
+        cosT.resize(frameSize);
+        sinT.resize(frameSize);
+        for (int i = 0; i < frameSize; i++) {
+            cosT[i] = std::cos(2 * M_PI * i / frameSize);
+            sinT[i] = std::sin(2 * M_PI * i / frameSize);
+        }
+    }
+
+    void process(const std::vector<float> &audio, int k, float *out) {
+        for (int i = 0; i < frameSize; i++) {
+            long s = (long)k * hop - frameSize / 2 + i;
+            frame[i] = (s >= 0 && s < (long)audio.size()) ? audio[s] : 0.0f;
+        }
+        SpectralOps::window(frame.data(), win.data(), windowed.data(), frameSize);
+        // Plain DFT of the odd-length frame; only the first 705 bins are used
+        std::vector<float> cpx(bins * 2);
+        for (int b = 0; b < bins; b++) {
+            double re = 0, im = 0;
+            long idx = 0;
+            for (int i = 0; i < frameSize; i++) {
+                re += windowed[i] * cosT[idx];
+                im -= windowed[i] * sinT[idx];
+                idx += b;
+                if (idx >= frameSize) idx -= frameSize;
+            }
+            cpx[2 * b] = (float)re;
+            cpx[2 * b + 1] = (float)im;
+        }
+        SpectralOps::magnitudes(cpx.data(), mags.data(), bins);
+        fb.apply(mags.data(), energy.data());
+        int n = fb.getNumBands();
+        SpectralOps::logCompress(energy.data(), out, n);
+        SpectralOps::positiveDiff(out, prev.data(), out + n, n);
+    }
+};
+
+static std::vector<float> readFloats(const std::string &path) {
+    std::vector<float> v;
+    FILE *f = fopen(path.c_str(), "rb");
+    if (!f) return v;
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    v.resize(size / sizeof(float));
+    size_t got = fread(v.data(), sizeof(float), v.size(), f);
+    v.resize(got);
+    fclose(f);
+    return v;
+}
+
+void test_log_filterbank() {
+    std::cout << "Testing Log Filterbank..." << std::endl;
+    ReferenceFrontEnd fe;
+    const SparseFilterbank &fb = fe.fb;
+    // 136 bands -> the model's 272 inputs
+    assert(fb.getNumBands() == 136);
+    for (int b = 0; b < fb.getNumBands(); b++) {
+        float sum = 0;
+        for (int i = 0; i < fb.getWidth(b); i++) sum += fb.getWeights(b)[i];
+        assert(std::abs(sum - 1.0f) < 1e-5f);
+        if (b > 0) assert(fb.getStart(b) > fb.getStart(b - 1));
+        assert(fb.getStart(b) + fb.getWidth(b) <= 705);
+    }
+    // Lowest band starts around 30Hz (22050 / 1410 Hz per bin)
+    assert(fb.getStart(0) >= 1 && fb.getStart(0) <= 3);
+
+    // A steady tone lights up the bands around its frequency and gives no onset after the first frame
+    std::vector<float> tone(22050);
+    for (size_t i = 0; i < tone.size(); i++) tone[i] = 0.5f * (float)std::sin(2 * M_PI * 1000.0 * i / 22050.0);
+    std::vector<float> f0(272), f1(272);
+    fe.process(tone, 20, f0.data());
+    fe.process(tone, 21, f1.data());
+    int peak = (int)(std::max_element(f1.begin(), f1.begin() + 136) - f1.begin());
+    double peakHz = (fb.getStart(peak) + fb.getWidth(peak) / 2.0) * 22050.0 / 1410.0;
+    assert(peakHz > 900 && peakHz < 1100);
+    for (int b = 136; b < 272; b++) assert(f1[b] < 1e-3f);
+
+    // Offline comparison against BeatNet's own features when available:
+    //   python export_beatnet.py --reference-features clip.wav --out /tmp/ref
+    //   BEATNET_REFERENCE=/tmp/ref ./unit_tests
+    const char *ref = std::getenv("BEATNET_REFERENCE");
+    if (ref) {
+        std::vector<float> audio = readFloats(std::string(ref) + ".audio.f32");
+        std::vector<float> want = readFloats(std::string(ref) + ".features.f32");
+        assert(!audio.empty() && want.size() % 272 == 0);
+        ReferenceFrontEnd cmp;
+        std::vector<float> got(272);
+        int frames = (int)want.size() / 272;
+        double maxErr = 0, sumErr = 0;
+        for (int k = 0; k < frames; k++) {
+            cmp.process(audio, k, got.data());
+            for (int i = 0; i < 272; i++) {
+                double e = std::abs(got[i] - want[k * 272 + i]);
+                maxErr = std::max(maxErr, e);
+                sumErr += e;
+            }
+        }
+        std::cout << "  reference: " << frames << " frames, max abs error " << maxErr
+                  << ", mean " << sumErr / (frames * 272.0) << std::endl;
+        assert(maxErr < 1e-3);
+    } else {
+        std::cout << "  BEATNET_REFERENCE not set, skipping comparison with BeatNet features" << std::endl;
+    }
+
+    std::cout << "Log Filterbank Unit Tests PASSED" << std::endl;
+}
+
+void test_latency_stats() {
+    std::cout << "Testing Latency Stats..." << std::endl;
+    LatencyStats s(1000, 100);
+    assert(s.get().count == 0);
+    s.add(5000);
+    assert(s.get().count == 1 && s.get().p50 == 5.0f); // published straight away while warming up
+
+    // 1..1000 us shuffled: percentiles land on the matching ranks
+    std::vector<int> v(1000);
+    for (int i = 0; i < 1000; i++) v[i] = i + 1;
+    for (int i = 999; i > 0; i--) std::swap(v[i], v[(i * 7919) % (i + 1)]);
+    LatencyStats w(1000, 100);
+    for (int x : v) w.add((int64_t)x * 1000);
+    LatencyStats::Summary r = w.get();
+    assert(r.count == 1000);
+    assert(std::abs(r.p50 - 500.5f) <= 1.0f);
+    assert(std::abs(r.p95 - 950.0f) <= 1.5f);
+    assert(std::abs(r.p99 - 990.0f) <= 1.5f);
+    assert(r.max == 1000.0f);
+
+    // The window rolls: old outliers drop out
+    for (int i = 0; i < 1000; i++) w.add(2000);
+    assert(w.get().max == 2.0f && w.get().p99 == 2.0f);
+
+    std::cout << "Latency Stats Unit Tests PASSED" << std::endl;
+}
+
+void test_resampler() {
+    std::cout << "Testing Resampler..." << std::endl;
+    auto tone = [](double freq, int rate, size_t n) {
+        std::vector<float> v(n);
+        for (size_t i = 0; i < n; i++) v[i] = 0.5f * (float)std::sin(2 * M_PI * freq * i / rate);
+        return v;
+    };
+    for (int inRate : {44100, 48000}) {
+        const size_t n = (size_t)inRate; // 1 second
+        PolyphaseResampler rs;
+        rs.setup(inRate, 22050, 512);
+        std::vector<float> out(rs.maxOutput(n));
+        std::vector<float> in = tone(1000.0, inRate, n);
+        size_t got = rs.process(in.data(), n, out.data(), out.size());
+        assert(std::abs((double)got - 22050.0) <= 2.0);
+
+        // A passband tone comes out as the same tone, delayed by getDelay()
+        double delay = rs.getDelay() / inRate;
+        double maxErr = 0;
+        for (size_t m = 2205; m < got; m++) {
+            double expected = 0.5 * std::sin(2 * M_PI * 1000.0 * (m / 22050.0 - delay));
+            maxErr = std::max(maxErr, std::abs(out[m] - expected));
+        }
+        assert(maxErr < 0.01);
+
+        // The newest output sits getOutputLag() input samples behind the newest input
+        double lagSeconds = rs.getOutputLag() / inRate;
+        double newest = (n - 1.0) / inRate - lagSeconds;
+        assert(std::abs(newest - ((got - 1) / 22050.0 - delay)) < 1.0 / inRate);
+
+        // Above the output Nyquist frequency: filtered out rather than aliased
+        PolyphaseResampler alias;
+        alias.setup(inRate, 22050, 512);
+        std::vector<float> high = tone(15000.0, inRate, n);
+        got = alias.process(high.data(), n, out.data(), out.size());
+        double energy = 0;
+        for (size_t m = 2205; m < got; m++) energy += out[m] * out[m];
+        double rms = std::sqrt(energy / (got - 2205));
+        std::cout << "  " << inRate << " Hz: passband error " << maxErr << ", 15 kHz leakage " << 20 * std::log10(rms / 0.3536) << " dB" << std::endl;
+        assert(rms < 0.3536 * 0.001); // -60 dB
+
+        // Streaming in odd block sizes gives the same samples as one call
+        PolyphaseResampler whole, chunked;
+        whole.setup(inRate, 22050, 4096);
+        chunked.setup(inRate, 22050, 256);
+        std::vector<float> a(whole.maxOutput(n)), b(a.size() + 64);
+        size_t na = whole.process(in.data(), n, a.data(), a.size());
+        size_t nb = 0;
+        for (size_t pos = 0, k = 0; pos < n; k++) {
+            size_t len = std::min(n - pos, (size_t)(1 + (k * 37) % 700));
+            nb += chunked.process(in.data() + pos, len, b.data() + nb, b.size() - nb);
+            pos += len;
+        }
+        assert(na == nb);
+        for (size_t i = 0; i < na; i++) assert(std::abs(a[i] - b[i]) < 1e-6f);
+    }
+
+    // Same rate passes straight through
+    PolyphaseResampler same;
+    same.setup(22050, 22050, 512);
+    std::vector<float> in = tone(440.0, 22050, 1000), out(1000);
+    assert(same.process(in.data(), 1000, out.data(), 1000) == 1000 && out == in && same.getDelay() == 0.0);
+
+    // Stereo downmix averages the channels
+    float stereo[] = {1.0f, 0.0f, 0.5f, 0.5f, -1.0f, 1.0f};
+    float mono[3];
+    downmix(stereo, mono, 3, 2);
+    assert(mono[0] == 0.5f && mono[1] == 0.5f && mono[2] == 0.0f);
+
+    // Cost of a 512-frame 48 kHz callback
+    PolyphaseResampler bench;
+    bench.setup(48000, 22050, 512);
+    std::vector<float> block = tone(440.0, 48000, 512), dst(bench.maxOutput(512));
+    const int blocks = 2000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < blocks; i++) bench.process(block.data(), 512, dst.data(), dst.size());
+    double perBlock = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / blocks;
+    std::cout << "  48 kHz -> 22050 Hz: " << perBlock << " us per 512 frames" << std::endl;
+    assert(perBlock < 1000.0);
+
+    std::cout << "Resampler Unit Tests PASSED" << std::endl;
+}
+
+void test_level_meter() {
+    std::cout << "Testing Level Meter..." << std::endl;
+    LevelMeter meter;
+    meter.setSampleRate(48000, 20.0f); // 960 samples per reading
+    std::vector<float> tone(4800);
+    for (size_t i = 0; i < tone.size(); i++) tone[i] = 0.5f * (float)std::sin(2 * M_PI * 1000.0 * i / 48000.0);
+    // Odd block sizes: readings still land every 960 samples
+    for (size_t pos = 0; pos < tone.size(); pos += 333) meter.process(tone.data() + pos, std::min((size_t)333, tone.size() - pos));
+    LevelMeter::Reading r[16];
+    size_t n = meter.popReadings(r, 16);
+    assert(n == 5);
+    for (size_t i = 0; i < n; i++) {
+        assert(std::abs(r[i].rms - 0.35355f) < 0.001f);
+        assert(std::abs(r[i].peak - 0.5f) < 0.001f);
+    }
+    assert(std::abs(LevelMeter::toDb(r[0].peak) + 6.02f) < 0.01f);
+    assert(meter.popReadings(r, 16) == 0);
+
+    // Nobody reading: the ring fills and drops instead of blocking
+    for (int i = 0; i < 100; i++) meter.process(tone.data(), 960);
+    size_t total = 0;
+    while ((n = meter.popReadings(r, 16)) > 0) total += n;
+    assert(total == 64);
+
+    // 136 bands averaged into 16 groups
+    std::vector<float> bands(136);
+    for (int i = 0; i < 136; i++) bands[i] = (float)i;
+    meter.processBands(bands.data(), 136);
+    LevelMeter::Spectrum sp;
+    assert(meter.popSpectra(&sp, 1) == 1);
+    assert(std::abs(sp.bands[0] - 3.5f) < 1e-4f); // bands 0..7
+    assert(std::abs(sp.bands[15] - 131.0f) < 1e-4f); // bands 127..135
+    for (int g = 1; g < LevelMeter::NUM_BANDS; g++) assert(sp.bands[g] > sp.bands[g - 1]);
+
+    std::cout << "Level Meter Unit Tests PASSED" << std::endl;
+}
+
+// Synthetic activations: a spike on every beat (downbeat row on beat 0 of the bar)
+static void beatActivations(int frame, double framesPerBeat, int meter, float &b, float &d) {
+    double beats = frame / framesPerBeat;
+    double frac = beats - std::floor(beats);
+    bool onBeat = frac * framesPerBeat < 1.0;
+    bool onDownbeat = onBeat && ((long)std::floor(beats) % meter) == 0;
+    b = onBeat && !onDownbeat ? 0.8f : 0.01f;
+    d = onDownbeat ? 0.7f : 0.01f;
+}
+
+void test_beat_particle_filter() {
+    std::cout << "Testing Beat Particle Filter..." << std::endl;
+    const double hop = 441.0 / 22050.0; // 20ms
+    for (int meter : {4, 3}) {
+        for (double bpm : {100.0, 128.0, 174.0}) {
+            BeatParticleFilter pf(hop);
+            double framesPerBeat = 60.0 / bpm / hop;
+            int frames = (int)(30.0 / hop);
+            int beats = 0, hits = 0, downbeats = 0, downbeatHits = 0;
+            for (int f = 0; f < frames; f++) {
+                float b, d;
+                beatActivations(f, framesPerBeat, meter, b, d);
+                const BeatParticleFilter::Result &r = pf.update(b, d);
+                if (f < 10 / hop) continue; // let it lock
+                if (!r.beat) continue;
+                beats++;
+                // Within one hop of a true beat, after the sub-hop correction
+                double beatPos = (f - r.beatOffset) / framesPerBeat;
+                double err = std::abs(beatPos - std::floor(beatPos + 0.5)) * framesPerBeat;
+                if (err <= 1.0) hits++;
+                if (r.downbeat) {
+                    downbeats++;
+                    if (err <= 1.0 && ((long)std::floor(beatPos + 0.5) % meter) == 0) downbeatHits++;
+                }
+            }
+            const BeatParticleFilter::Result &r = pf.getResult();
+            double expected = 20.0 * bpm / 60.0;
+            std::cout << "  " << meter << "/4 @" << bpm << ": bpm " << r.bpm << ", beats " << hits << "/" << beats
+                      << " (expected ~" << (int)expected << "), downbeats " << downbeatHits << "/" << downbeats
+                      << ", meter " << r.meter << ", confidence " << r.confidence << std::endl;
+            assert(std::abs(r.bpm - bpm) < 3.0);
+            assert(r.meter == meter);
+            assert(std::abs(beats - expected) <= 2 && hits >= beats - 1);
+            assert(downbeats > 0 && downbeatHits >= downbeats - 1);
+            assert(r.confidence > 0.8f);
+        }
+    }
+
+    // Tempo change mid-track: the filter must leave the old tempo and lock
+    // the new one rather than settle near it
+    for (auto change : {std::make_pair(174.0, 120.0), std::make_pair(100.0, 140.0)}) {
+        BeatParticleFilter pf(hop);
+        int switchFrame = (int)(10.0 / hop), frames = switchFrame + (int)(15.0 / hop);
+        for (int f = 0; f < frames; f++) {
+            float b, d;
+            if (f < switchFrame) beatActivations(f, 60.0 / change.first / hop, 4, b, d);
+            else beatActivations(f - switchFrame, 60.0 / change.second / hop, 4, b, d);
+            pf.update(b, d);
+        }
+        const BeatParticleFilter::Result &r = pf.getResult();
+        std::cout << "  " << change.first << " -> " << change.second << " BPM: bpm " << r.bpm << ", confidence " << r.confidence << std::endl;
+        assert(std::abs(r.bpm - change.second) < 3.0);
+        assert(r.confidence > 0.8f);
+    }
+
+    // Silence: no lock, low confidence
+    BeatParticleFilter quiet(hop);
+    for (int f = 0; f < 500; f++) quiet.update(0.01f, 0.01f);
+    assert(quiet.getResult().confidence < 0.5f);
+
+    // Cost per hop with the default 1500 particles
+    BeatParticleFilter bench(hop);
+    const int n = 5000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < n; f++) {
+        float b, d;
+        beatActivations(f, 23.4, 4, b, d);
+        bench.update(b, d);
+    }
+    double perHop = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / n;
+    std::cout << "  " << bench.getNumParticles() << " particles: " << perHop << " us per hop" << std::endl;
+    assert(perHop < 1000.0);
+
+    std::cout << "Beat Particle Filter Unit Tests PASSED" << std::endl;
+}
+void test_tempo_sync() {
+    std::cout << "Testing Tempo Sync..." << std::endl;
+    const int64_t S = Timebase::NS_PER_SEC;
+    const int64_t start = 40LL * 24 * 3600 * S; // weeks of uptime
+    Metronome m;
+    m.bpm = 120.0f;
+    m.referenceTimeNs = start - 1000 * S;
+    TempoSync sync;
+
+    // The music is at 126 BPM, a third of a beat off, downbeat one beat later
+    const double musicBpm = 126.0;
+    const int64_t musicStart = start + S / 7;
+    auto musicBeat = [&](int k) { return musicStart + Timebase::beatsToNs(k, musicBpm); };
+
+    // Low confidence: nothing changes
+    for (int k = 0; k < 8; k++) assert(!sync.onBeat(m, musicBeat(k), 126.0f, 0.5f));
+    assert(!sync.isLocked() && m.bpm == 120.0f);
+
+    // Interrupted streaks don't lock
+    for (int k = 8; k < 11; k++) sync.onBeat(m, musicBeat(k), 126.0f, 0.9f);
+    sync.onBeat(m, musicBeat(11), 126.0f, 0.6f);
+    assert(!sync.isLocked());
+
+    // Confident beats lock after engageBeats, then pull tempo and phase in
+    int k = 12;
+    for (; k < 16; k++) sync.onBeat(m, musicBeat(k), 126.0f, 0.9f, k % 4 == 1, 4);
+    assert(sync.isLocked());
+    double maxStep = 0;
+    float prevBpm = m.bpm;
+    for (; k < 100; k++) {
+        sync.onBeat(m, musicBeat(k), 126.0f, 0.9f, k % 4 == 1, 4);
+        maxStep = std::max(maxStep, (double)std::abs(m.bpm - prevBpm));
+        prevBpm = m.bpm;
+    }
+    assert(std::abs(m.bpm - 126.0f) < 0.05f);
+    assert(maxStep <= 0.1 * 6.0 + 1e-3); // at most a tenth of the gap per beat
+    double pos = m.getBeatAt(musicBeat(k));
+    assert(std::abs(pos - std::floor(pos + 0.5)) < 0.01);
+    // Downbeats realigned the bar: music beat k is a downbeat when k % 4 == 1
+    int64_t beat = (int64_t)std::floor(m.getBeatAt(musicBeat(101)) + 0.5);
+    assert(((beat % 4) + 4) % 4 == 0);
+
+    // Hysteresis: dipping between the thresholds keeps the lock, below releases it
+    assert(sync.onBeat(m, musicBeat(k++), 126.0f, 0.5f));
+    assert(sync.isLocked());
+    assert(!sync.onBeat(m, musicBeat(k++), 126.0f, 0.3f));
+    assert(!sync.isLocked());
+
+    std::cout << "Tempo Sync Unit Tests PASSED" << std::endl;
+}
 int main() {
     try {
         test_metronome_logic();
+        test_metronome_uptime();
         test_skew_logic();
+        test_cluster_clock();
+        test_control_point_index();
+        test_content_lifecycle();
+        test_video_pll();
+        test_beat_scheduler();
+        test_spsc_ring();
+        test_spectral_features();
+        test_log_filterbank();
+        test_latency_stats();
+        test_resampler();
+        test_level_meter();
+        test_beat_particle_filter();
+        test_tempo_sync();
     } catch (const std::exception& e) {
         std::cerr << "Test failed with exception: " << e.what() << std::endl;
         return 1;